@@ -0,0 +1,32 @@
+#ifndef NOWTECH_FIBONACCIMALLOC
+#define NOWTECH_FIBONACCIMALLOC
+
+/* C API over one global NewDelete, implemented in tools/fibonaccimalloc.cpp.
+   The heap is created on the first call. The functions follow their C library
+   counterparts, and set errno to ENOMEM when out of memory. */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void*  fmm_malloc(size_t aSize);
+void   fmm_free(void* aPointer);
+void*  fmm_calloc(size_t aCount, size_t aSize);
+void*  fmm_realloc(void* aPointer, size_t aSize);
+
+/* aAlignment must be a power of 2. */
+void*  fmm_memalign(size_t aAlignment, size_t aSize);
+
+/* Returns EINVAL unless aAlignment is a power of 2 multiple of sizeof(void*), ENOMEM if out of memory, 0 otherwise. */
+int    fmm_posix_memalign(void** aResult, size_t aAlignment, size_t aSize);
+
+/* Returns the bytes usable from aPointer, or 0 for NULL or a pointer not allocated here. */
+size_t fmm_usable_size(void const* aPointer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
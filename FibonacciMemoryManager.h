@@ -5,9 +5,17 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
 #include <numeric>
 #include <array>
 #include <set>
+#include <type_traits>
+#include <utility>
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 namespace nowtech { namespace memory {
 
@@ -20,12 +28,411 @@ constexpr size_t countSetBits(size_t aNumber) noexcept {
   return count; 
 }
 
+/// @returns the index of the lowest set bit, aNumber must not be 0.
+inline size_t countTrailingZeros(size_t const aNumber) noexcept {
+#if defined(__GNUC__)
+  return static_cast<size_t>(__builtin_ctzll(aNumber));
+#else
+  size_t count = 0u;
+  while((aNumber & (static_cast<size_t>(1u) << count)) == 0u) {
+    ++count;
+  }
+  return count;
+#endif
+}
+
+/// @returns the index of the highest set bit, aNumber must not be 0.
+inline size_t getHighestSetBit(size_t const aNumber) noexcept {
+#if defined(__GNUC__)
+  return static_cast<size_t>(sizeof(unsigned long long) * 8u - 1u - __builtin_clzll(aNumber));
+#else
+  size_t index = sizeof(size_t) * 8u - 1u;
+  while((aNumber & (static_cast<size_t>(1u) << index)) == 0u) {
+    --index;
+  }
+  return index;
+#endif
+}
+
+/// @returns the count of generalized Fibonacci numbers not larger than aMaxValue.
+constexpr size_t calculateFibonacciCount(size_t const aMaxValue, size_t const aDifference) noexcept {
+  size_t last[9u] = { 0u, 0u, 0u, 0u, 0u, 0u, 0u, 0u, 0u }; // F[k-1-D] ... F[k-1] modulo D+1
+  size_t count = 0u;
+  size_t next = 1u;
+  while(next <= aMaxValue) {
+    last[count % (aDifference + 1u)] = next;
+    ++count;
+    next = (count <= aDifference ? count + 1u : last[(count - 1u) % (aDifference + 1u)] + last[count % (aDifference + 1u)]);
+  }
+  return count;
+}
+
+enum class FibonacciDirection : uint8_t {
+  cInvalid = 0u,
+  cLeft    = 1u << 5u, // direction to smaller son, index is i-D-1
+  cRight   = 2u << 5u, // direction to larger son,  index is i-1  
+  cHere    = 3u << 5u  // assume the index is i
+};
+
+class FibonacciCell final {
+private:
+  static constexpr uint16_t cMaskDirection  = static_cast<uint16_t>(FibonacciDirection::cHere);
+  static constexpr uint16_t cMaskExact      = 1u << 7u;
+
+  uint8_t mValue;
+
+public:
+  constexpr FibonacciCell() noexcept : mValue(static_cast<uint16_t>(FibonacciDirection::cInvalid)) {
+  }
+
+  constexpr void set(bool const aExact) noexcept {
+    mValue = (aExact ? cMaskExact : 0u) | static_cast<uint16_t>(FibonacciDirection::cHere);
+  }
+
+  constexpr void set(bool const aExact, FibonacciDirection const aDir) noexcept {
+    mValue = (aExact ? cMaskExact : 0u) | static_cast<uint16_t>(aDir);
+  }
+
+  constexpr bool isExact() const noexcept {
+    return (mValue & cMaskExact) != 0u;
+  }
+
+  constexpr FibonacciDirection getDirection() const noexcept {
+    return static_cast<FibonacciDirection>(mValue & cMaskDirection);
+  }
+};
+static_assert(sizeof(FibonacciCell) == sizeof(uint8_t), "Assures that FibonacciCell is 1 byte long.");
+static_assert(alignof(FibonacciCell) == alignof(uint8_t), "Assures that FibonacciCell has the alignment of a byte.");
+
+/// The Fibonacci numbers and the allocation directions for both allocation strategies, computed during compilation.
+/// Every FibonacciMemoryManager instantiation shares one read-only copy.
+template <size_t tCount, size_t tDifference>
+class FibonacciTables final {
+public:
+  static constexpr size_t cBitsPerWord = sizeof(size_t) * 8u;
+  static constexpr size_t cBitmapWords = (tCount + cBitsPerWord - 1u) / cBitsPerWord;
+  static constexpr size_t cSizeClassCount = 256u;         // unit block counts below this are looked up directly
+  static constexpr size_t cLogBucketCount = cBitsPerWord; // larger ones start from the bucket of their highest bit
+  static_assert(tCount < 65536u, "The Fibonacci indices must fit in 16 bits.");
+
+  size_t        mFibonaccis[tCount];
+  FibonacciCell mDirections[2u][tCount * tCount]; // [0] for normal, [1] for exact allocation, each indexed by i * tCount + j
+  size_t        mExactMasks[tCount * cBitmapWords]; // for each target index, bit i tells if i can be split into it exactly
+  uint16_t      mSizeClasses[cSizeClassCount]; // the smallest index i for which F[i] >= u unit blocks, tCount if none
+  uint16_t      mLogBuckets[cLogBucketCount];  // the smallest index i for which F[i] >= 2^b, tCount if none
+
+  constexpr FibonacciTables() noexcept : mFibonaccis(), mDirections(), mExactMasks(), mSizeClasses(), mLogBuckets() {
+    for(size_t i = 0u; i < tCount; ++i) {
+      mFibonaccis[i] = (i <= tDifference ? i + 1u : mFibonaccis[i - 1u] + mFibonaccis[i - 1u - tDifference]);
+    }
+    for(size_t u = 0u; u < cSizeClassCount; ++u) {
+      mSizeClasses[u] = static_cast<uint16_t>(searchIndex(u));
+    }
+    for(size_t b = 0u; b < cLogBucketCount; ++b) {
+      mLogBuckets[b] = static_cast<uint16_t>(searchIndex(static_cast<size_t>(1u) << b));
+    }
+    fillDirections(false);
+    fillDirections(true);
+    for(size_t j = 0u; j < tCount; ++j) {
+      for(size_t i = j; i < tCount; ++i) {
+        if(mDirections[1u][i * tCount + j].isExact()) {
+          mExactMasks[j * cBitmapWords + i / cBitsPerWord] |= static_cast<size_t>(1u) << (i % cBitsPerWord);
+        }
+        else { // nothing to do
+        }
+      }
+    }
+  }
+
+  /// @returns the smallest index i for which F[i] >= aUnits, or tCount if there is none.
+  /// Looks in the size class table, or starts from the bucket of the highest bit and steps over
+  /// the few Fibonacci numbers below aUnits sharing that bit.
+  size_t getIndex(size_t const aUnits) const noexcept {
+    size_t result;
+    if(aUnits < cSizeClassCount) {
+      result = mSizeClasses[aUnits];
+    }
+    else {
+      result = mLogBuckets[getHighestSetBit(aUnits)];
+      while(result < tCount && mFibonaccis[result] < aUnits) {
+        ++result;
+      }
+    }
+    return result;
+  }
+
+private:
+  constexpr size_t searchIndex(size_t const aUnits) const noexcept {
+    size_t result = 0u;
+    while(result < tCount && mFibonaccis[result] < aUnits) {
+      ++result;
+    }
+    return result;
+  }
+
+  constexpr void fillDirections(bool const aExactAllocation) noexcept {
+    FibonacciCell* directions = mDirections[aExactAllocation ? 1u : 0u];
+    for(size_t i = 0u; i < tCount; ++i) {
+      directions[i * tCount + i].set(true);
+    }
+    for(size_t i = 1u; i <= tDifference && i < tCount; ++i) {
+      for(size_t j = 0u; j < i; ++j) {
+        directions[i * tCount + j].set(false);
+      }
+    }
+    for(size_t i = tDifference + 1u; i < tCount; ++i) {
+      for(size_t j = 0u; j < i; ++j) {
+        bool const leftPossible = j <= i - tDifference - 1u;
+        bool const leftExact = leftPossible && directions[(i - tDifference - 1u) * tCount + j].isExact();
+        bool const rightExact = directions[(i - 1u) * tCount + j].isExact();
+        if(aExactAllocation) {
+          if(leftExact) {
+            directions[i * tCount + j].set(true, FibonacciDirection::cLeft);
+          }
+          else if(rightExact) {
+            directions[i * tCount + j].set(true, FibonacciDirection::cRight);
+          }
+          else if(leftPossible) {
+            directions[i * tCount + j].set(false, FibonacciDirection::cLeft);
+          }
+          else {
+            directions[i * tCount + j].set(false, FibonacciDirection::cRight);
+          }
+        }
+        else {
+          if(leftPossible) {
+            directions[i * tCount + j].set(leftExact, FibonacciDirection::cLeft);
+          }
+          else {
+            directions[i * tCount + j].set(rightExact, FibonacciDirection::cRight);
+          }
+        }
+      }
+    }
+  }
+};
+
+/// A minimal yielding lock for the locking modes not relying on tInterface.
+class SpinLock final {
+private:
+  std::atomic_flag mFlag = ATOMIC_FLAG_INIT;
+
+public:
+  void lock() noexcept {
+    while(mFlag.test_and_set(std::memory_order_acquire)) {
+      std::this_thread::yield(); // lets a preempted owner finish when there are more threads than cores
+    }
+  }
+
+  bool try_lock() noexcept {
+    return !mFlag.test_and_set(std::memory_order_acquire);
+  }
+
+  void unlock() noexcept {
+    mFlag.clear(std::memory_order_release);
+  }
+};
+
+/// Stores the distance of the pointee from itself, so a heap image full of such links stays valid
+/// wherever it is mapped. 0 stands for nullptr, because a link never points to itself.
+template <typename tPointee>
+class OffsetPointer final {
+private:
+  ptrdiff_t mOffset = 0;
+
+public:
+  OffsetPointer() noexcept = default;
+
+  OffsetPointer(tPointee* const aPointer) noexcept {
+    set(aPointer);
+  }
+
+  OffsetPointer(OffsetPointer const& aOther) noexcept {
+    set(aOther.get());
+  }
+
+  OffsetPointer& operator=(OffsetPointer const& aOther) noexcept {
+    set(aOther.get());
+    return *this;
+  }
+
+  OffsetPointer& operator=(tPointee* const aPointer) noexcept {
+    set(aPointer);
+    return *this;
+  }
+
+  tPointee* get() const noexcept {
+    return mOffset == 0 ? nullptr : reinterpret_cast<tPointee*>(reinterpret_cast<uintptr_t>(this) + static_cast<uintptr_t>(mOffset));
+  }
+
+  operator tPointee*() const noexcept {
+    return get();
+  }
+
+  tPointee* operator->() const noexcept {
+    return get();
+  }
+
+private:
+  void set(tPointee* const aPointer) noexcept {
+    mOffset = (aPointer == nullptr ? 0 : static_cast<ptrdiff_t>(reinterpret_cast<uintptr_t>(aPointer) - reinterpret_cast<uintptr_t>(this)));
+  }
+};
+
+enum class FibonacciLocking : uint8_t {
+  cInterface, // each operation is wrapped in tInterface::lock() and tInterface::unlock()
+  cInstance,  // each manager instance has its own lock of type tConfig::InstanceLock
+  cPerIndex   // experimental, each Fibonacci index has its own lock of type tConfig::InstanceLock, needs intrusive free lists
+};
+
+enum class FibonacciPlacement : uint8_t {
+  cFirstFit,   // the first region in declaration order able to serve the request, so the fastest memory should come first
+  cSmallestFit // the region with the smallest largest free block still fitting, keeping the large blocks for large requests
+};
+
+enum class FibonacciReuse : uint8_t {
+  cLowestAddress, // the free block with the lowest address, keeping the end of the heap free for large blocks
+  cLastFreed,     // the most recently released block still free, which is likely still in the cache
+  cSamePage       // the lowest free block in the page of a recently released one, otherwise the lowest
+};
+
+/// Snapshot returned by FibonacciMemoryManager::getStatistics(), filled only if FibonacciConfig::cStatistics.
+/// The counters are read one by one without locking, so they may be slightly inconsistent under concurrent use.
+template <size_t tIndexCount>
+struct FibonacciStatistics final {
+  size_t   mIndexCount;                 // valid entries in the arrays below
+  size_t   mAllocations[tIndexCount];   // successful allocations by the index of the block given
+  size_t   mDeallocations[tIndexCount];
+  size_t   mSplits;
+  size_t   mMerges;
+  size_t   mFailures;                   // allocation requests which could not be served
+  size_t   mUsed;                       // getMaxUserBlockSize() - mFreeSpace: the allocated blocks with the headers of all blocks but one, and slabs as a whole
+  size_t   mPeakUsed;                   // the largest mUsed seen after an allocation
+  size_t   mRequestedBytes;             // summed over all allocations
+  size_t   mGrantedBytes;               // user sizes of the blocks given, summed over all allocations
+  size_t   mFreeSpace;
+  size_t   mMaxFreeUserBlockSize;
+  uint64_t mLockNanoseconds;            // spent acquiring the locks
+
+  size_t getInternalFragmentation() const noexcept {
+    return mGrantedBytes - mRequestedBytes;
+  }
+
+  /// @returns 0 if the free space is in one block, approaching 1 as it is scattered among small ones.
+  double getExternalFragmentation() const noexcept {
+    return mFreeSpace == 0u ? 0.0 : 1.0 - static_cast<double>(mMaxFreeUserBlockSize) / static_cast<double>(mFreeSpace);
+  }
+
+  /// Sums the counters of another manager of the same type. The peaks are summed, so the result is an upper bound.
+  void add(FibonacciStatistics const& aOther) noexcept {
+    for(size_t i = 0u; i < mIndexCount; ++i) {
+      mAllocations[i] += aOther.mAllocations[i];
+      mDeallocations[i] += aOther.mDeallocations[i];
+    }
+    mSplits += aOther.mSplits;
+    mMerges += aOther.mMerges;
+    mFailures += aOther.mFailures;
+    mUsed += aOther.mUsed;
+    mPeakUsed += aOther.mPeakUsed;
+    mRequestedBytes += aOther.mRequestedBytes;
+    mGrantedBytes += aOther.mGrantedBytes;
+    mFreeSpace += aOther.mFreeSpace;
+    mMaxFreeUserBlockSize = std::max(mMaxFreeUserBlockSize, aOther.mMaxFreeUserBlockSize);
+    mLockNanoseconds += aOther.mLockNanoseconds;
+  }
+};
+
+/// Compile-time options of FibonacciMemoryManager and NewDelete. The application may
+/// derive its own configuration from this and redefine the members it wants to change.
+struct FibonacciConfig {
+  /// If true, free blocks are linked through their own storage in doubly linked lists,
+  /// so no std::set nodes and no pool for them are needed. Free blocks are reused in LIFO order.
+  /// If false, free blocks are kept in address order in std::sets.
+  static constexpr bool cIntrusiveFreeLists = false;
+
+  /// Chooses among the free blocks of an index in the std::set mode. The intrusive free lists are always LIFO.
+  static constexpr FibonacciReuse cReuse = FibonacciReuse::cLowestAddress;
+
+  /// Number of blocks each thread may keep for an index in NewDelete without returning them
+  /// to the manager. Refilling and flushing happens in batches of half of this. 0 disables the thread caches.
+  static constexpr size_t cThreadCacheDepth = 0u;
+
+  /// Only blocks with Fibonacci index below this are kept in the thread caches.
+  static constexpr size_t cThreadCacheIndexCount = 8u;
+
+  /// If true, deallocation puts the blocks in the free list of their own index without merging
+  /// them with their buddies. Merging happens in one pass when an allocation can't be satisfied,
+  /// when more than cLazyWatermark blocks were freed on one index since the last pass, or on coalesce().
+  static constexpr bool cLazyCoalescing = false;
+
+  static constexpr size_t cLazyWatermark = 64u;
+
+  /// If true, the block size is rounded down to a power of two, so converting a request
+  /// to unit blocks is a shift instead of a division. This may leave up to half of the memory unused.
+  static constexpr bool cPowerOfTwoBlockSize = false;
+
+  /// Free blocks of at least this Fibonacci index have their whole pages given back to the system
+  /// by tInterface::decommit(void* aStart, size_t aLength) when they are freed or merged,
+  /// for example using madvise with MADV_DONTNEED. The default disables it.
+  static constexpr size_t cDecommitIndex = std::numeric_limits<size_t>::max();
+
+  /// Page size used for decommitting, must be a power of 2.
+  static constexpr size_t cPageSize = 4096u;
+
+  /// If true, the manager counts its operations and the time spent waiting for locks, see getStatistics().
+  /// If false, the counting code is left out. NewDelete does not allow it together with cThreadCacheDepth.
+  static constexpr bool cStatistics = false;
+
+  /// If positive, NewDelete asks tInterface::grow(size_t aSize) for at most this many additional regions
+  /// of tMemorySize bytes when an allocation would fail, and serves the request from a new
+  /// FibonacciMemoryManager there. grow must return memory aligned like std::max_align_t, or nullptr.
+  /// NewDelete::releaseEmptyRegions() gives the regions back by tInterface::release(void* aMemory, size_t aSize).
+  static constexpr size_t cGrowthRegionCount = 0u;
+
+  /// If positive, requests of at most cSlabClassCount * tAlignment bytes are served from slabs: blocks of at least
+  /// cSlabSize bytes carved into equal slots of a size class, the multiples of tAlignment. The slots have no header,
+  /// so small objects take much less than a whole block. 0 disables the slabs.
+  static constexpr size_t cSlabClassCount = 0u;
+
+  /// Minimal user size of a slab block.
+  static constexpr size_t cSlabSize = 4096u;
+
+  /// If true, the links inside the heap are stored as offsets, so a heap built in memory mapped from a file
+  /// can be unmapped and resumed by attach() at any address later. Needs cIntrusiveFreeLists.
+  static constexpr bool cPositionIndependent = false;
+
+  /// If true, deallocate() does not wait when an other thread holds the lock, but pushes the block on a lock-free list
+  /// with one compare and swap. The next operation taking the lock frees the whole list in address order. Needs cInstance locking.
+  static constexpr bool cRemoteFree = false;
+
+  /// If true, the block headers are kept in a table of 4 bytes per unit block after the free lists instead of before
+  /// each payload, so the whole block belongs to the user and the payloads start on the block boundaries.
+  static constexpr bool cHeaderless = false;
+
+  /// If positive, NewDelete has a table of this many handles for movable blocks, see NewDelete::_allocateHandle.
+  /// NewDelete::compact() moves the blocks of the handles not pinned out of a sparsely used part of the heap, so it can merge.
+  static constexpr size_t cHandleCount = 0u;
+
+  /// FibonacciLocking::cPerIndex is experimental: it was slower than a single lock in the thread benchmarks,
+  /// which could only run on one core, so its scaling is unproven.
+  static constexpr FibonacciLocking cLocking = FibonacciLocking::cInterface;
+
+  /// Used for FibonacciLocking::cInstance and cPerIndex, needs lock() and unlock().
+  typedef SpinLock InstanceLock;
+};
+
+/// Used by ShardedNewDelete to give each arena its own lock unless the application has chosen one.
+template <typename tConfig>
+struct FibonacciArenaConfig : public tConfig {
+  static constexpr FibonacciLocking cLocking = (tConfig::cLocking == FibonacciLocking::cInterface ? FibonacciLocking::cInstance : tConfig::cLocking);
+};
+
 /// class Interface {
 ///   static void badAlloc();
 ///   static void lock();
 ///   static void unlock();
 /// };
-template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory = 0u>
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory = 0u, typename tConfig = FibonacciConfig>
 class FibonacciMemoryManager final {
   static_assert(tMemorySize >= 16384, "User supplied memory must be at least 16 kB.");
   static_assert(tMemorySize % alignof(std::max_align_t) == 0u, "User supplied memory must be a multiply of the largest system alignment type.");
@@ -35,8 +442,41 @@ class FibonacciMemoryManager final {
   static_assert(countSetBits(tAlignment) == 1u, "The desired alignment must be a power of 2.");
   static_assert(tFibonacciIndexDifference > 0u, "The Fibonacci difference must be at least 1.");
   static_assert(tFibonacciIndexDifference < 9u, "The Fibonacci difference must be less than 9.");
+  static_assert(!tConfig::cIntrusiveFreeLists || tAlignment >= alignof(uint8_t*), "Intrusive free lists require the alignment to be at least that of a pointer.");
+  static_assert(!tConfig::cIntrusiveFreeLists || tMinimalBlockSize >= (tConfig::cHeaderless ? 0u : tAlignment) + 2u * sizeof(uint8_t*), "Intrusive free lists require room for two pointers after the block header.");
+  static_assert(tConfig::cLocking != FibonacciLocking::cPerIndex || tConfig::cIntrusiveFreeLists, "Per-index locking requires intrusive free lists, because the std::sets share one pool.");
+  static_assert(!tConfig::cRemoteFree || tConfig::cLocking == FibonacciLocking::cInstance, "Remote free needs the try_lock of the instance lock.");
+  static_assert(!tConfig::cRemoteFree || tAlignment >= sizeof(size_t), "Remote free links the blocks through their first word.");
+  static_assert(!tConfig::cPositionIndependent || tConfig::cIntrusiveFreeLists, "A position independent heap requires intrusive free lists, because the std::set nodes hold raw pointers.");
+  static_assert(countSetBits(tConfig::cPageSize) == 1u, "The page size must be a power of 2.");
 
 private:
+  static constexpr size_t cMaxFibonacciCount = calculateFibonacciCount(tMemorySize / tMinimalBlockSize, tFibonacciIndexDifference);
+  static constexpr size_t cBitsPerWord       = sizeof(size_t) * 8u;
+  static constexpr size_t cBitmapWords       = (cMaxFibonacciCount + cBitsPerWord - 1u) / cBitsPerWord;
+  static constexpr bool   cPerIndexLocking   = tConfig::cLocking == FibonacciLocking::cPerIndex;
+  static constexpr size_t cLevelLockCount    = cPerIndexLocking ? cMaxFibonacciCount : 1u;
+  static constexpr size_t cUncoalescedCount  = tConfig::cLazyCoalescing ? cMaxFibonacciCount : 1u;
+  static constexpr size_t cCacheLineSize     = 64u;
+  static constexpr size_t cLevelLockSize     = (sizeof(typename tConfig::InstanceLock) / cCacheLineSize + 1u) * cCacheLineSize;
+  static constexpr size_t cBulkSortChunk     = 64u;
+  static constexpr bool   cDecommitEnabled   = tConfig::cDecommitIndex < cMaxFibonacciCount;
+  static constexpr size_t cDecommitScanLength = 8u; // free blocks examined to find a committed one
+  static constexpr size_t cStatisticsIndexCount = tConfig::cStatistics ? cMaxFibonacciCount : 1u;
+  static constexpr bool   cSlabEnabled       = tConfig::cSlabClassCount > 0u;
+  static constexpr size_t cSlabClassCount    = cSlabEnabled ? tConfig::cSlabClassCount : 1u;
+  static constexpr size_t cMaxSlotSize       = tConfig::cSlabClassCount * tAlignment;
+  static constexpr size_t cSlabBitmapWords   = (tConfig::cSlabSize / tAlignment + cBitsPerWord - 1u) / cBitsPerWord;
+  static constexpr size_t cSlabStartWords    = cSlabEnabled ? (tMemorySize / tMinimalBlockSize + cBitsPerWord - 1u) / cBitsPerWord : 1u;
+  static constexpr size_t cSlabLockCount     = cSlabEnabled && cPerIndexLocking ? cSlabClassCount : 1u;
+  static constexpr size_t cHeaderSize        = tConfig::cHeaderless ? 0u : tAlignment; // before each payload
+  static constexpr bool   cReuseEnabled      = !tConfig::cIntrusiveFreeLists && tConfig::cReuse != FibonacciReuse::cLowestAddress;
+  static constexpr size_t cRecentIndexCount  = cReuseEnabled ? cMaxFibonacciCount : 1u;
+  static constexpr size_t cRecentDepth       = 4u; // released blocks remembered on each index for cReuse
+
+  typedef FibonacciTables<cMaxFibonacciCount, tFibonacciIndexDifference> Tables;
+  static constexpr Tables cTables = Tables();
+
   class FixedOccupier final {
   private:
     void*  mMemory;
@@ -58,110 +498,274 @@ private:
     }
   };
 
-  enum class FibonacciDirection : uint8_t {
-    cInvalid = 0u,
-    cLeft    = 1u << 5u, // direction to smaller son, index is i-D-1
-    cRight   = 2u << 5u, // direction to larger son,  index is i-1  
-    cHere    = 3u << 5u  // assume the index is i
-  };
-
-  class FibonacciCell final {
-  private:
-    static constexpr uint16_t cMaskDirection  = static_cast<uint16_t>(FibonacciDirection::cHere);
-    static constexpr uint16_t cMaskExact      = 1u << 7u;
-
-    uint8_t mValue;
-
-  public:
-    FibonacciCell() noexcept : mValue(static_cast<uint16_t>(FibonacciDirection::cInvalid)) {
-    }
-
-    void set(bool const aExact) noexcept {
-      mValue = (aExact ? cMaskExact : 0u) | static_cast<uint16_t>(FibonacciDirection::cHere);
-    }
-
-    void set(bool const aExact, FibonacciDirection const aDir) noexcept {
-      mValue = (aExact ? cMaskExact : 0u) | static_cast<uint16_t>(aDir);
-    }
-
-    bool isExact() const noexcept {
-      return (mValue & cMaskExact) != 0u;
-    }
-
-    FibonacciDirection getDirection() const noexcept {
-      return static_cast<FibonacciDirection>(mValue & cMaskDirection);
-    }
-  };
-  static_assert(sizeof(FibonacciCell) == sizeof(uint8_t), "Assures that FibonacciCell is 1 byte long.");
-  static_assert(alignof(FibonacciCell) == alignof(uint8_t), "Assures that FibonacciCell has the alignment of a byte.");
-
   class BlockHeader final {
   private:
     static constexpr uint32_t cMaskBuddy  = 1u << 31u;
     static constexpr uint32_t cMaskMemory = 1u << 30u;
-    static constexpr uint32_t cMaskIndex  = (1u << 30u) - 1u;
-    uint32_t mValue;
+    static constexpr uint32_t cMaskFree    = 1u << 29u;
+    static constexpr uint32_t cMaskShifted = 1u << 28u; // placed before an over-aligned payload or in the table entry of its unit, the index field holds the distance of the payload without header from the block start in tAlignment units
+    static constexpr uint32_t cMaskDecommitted = 1u << 27u; // a free block whose pages were given back to the system
+    static constexpr uint32_t cMaskRemote  = 1u << 26u; // an allocated block waiting in the remote free list
+    static constexpr uint32_t cMaskCached  = 1u << 25u; // an allocated block kept by a front end for reuse
+    static constexpr uint32_t cMaskIndex   = (1u << 25u) - 1u;
+    std::atomic<uint32_t> mValue; // relaxed, because other threads may only peek at it during coalescing in per-index locking
 
   public:
     BlockHeader() noexcept = default;
    
     bool getBuddy() const noexcept {
-      return (mValue & cMaskBuddy) != 0u;
+      return (mValue.load(std::memory_order_relaxed) & cMaskBuddy) != 0u;
     } 
    
     bool getMemory() const noexcept {
-      return (mValue & cMaskMemory) != 0u;
+      return (mValue.load(std::memory_order_relaxed) & cMaskMemory) != 0u;
     } 
    
+    bool isFree() const noexcept {
+      return (mValue.load(std::memory_order_relaxed) & cMaskFree) != 0u;
+    }
+
+    bool isShifted() const noexcept {
+      return (mValue.load(std::memory_order_relaxed) & cMaskShifted) != 0u;
+    }
+
+    bool isDecommitted() const noexcept {
+      return (mValue.load(std::memory_order_relaxed) & cMaskDecommitted) != 0u;
+    }
+
+    bool isRemote() const noexcept {
+      return (mValue.load(std::memory_order_relaxed) & cMaskRemote) != 0u;
+    }
+
     size_t getIndex() const noexcept {
-      return mValue & cMaskIndex;
+      return mValue.load(std::memory_order_relaxed) & cMaskIndex;
     }
 
+    /// Sets a used block.
     void set(bool const aBuddy, bool const aMemory, size_t const aIndex) noexcept {
-      mValue = (aBuddy ? cMaskBuddy : 0u) |
-               (aMemory ? cMaskMemory : 0u) |
-               static_cast<uint32_t>(aIndex & cMaskIndex);
+      mValue.store((aBuddy ? cMaskBuddy : 0u) |
+                   (aMemory ? cMaskMemory : 0u) |
+                   static_cast<uint32_t>(aIndex & cMaskIndex), std::memory_order_relaxed);
+    }
+
+    void setShifted(size_t const aDistance) noexcept {
+      mValue.store(cMaskShifted | static_cast<uint32_t>(aDistance & cMaskIndex), std::memory_order_relaxed);
+    }
+
+    /// Taking a block out of the free ones keeps its decommitted state for splitting it, the allocation clears it.
+    void setFree(bool const aFree) noexcept {
+      uint32_t value = mValue.load(std::memory_order_relaxed);
+      mValue.store(aFree ? (value | cMaskFree) : (value & ~cMaskFree), std::memory_order_relaxed);
+    }
+
+    void setDecommitted(bool const aDecommitted) noexcept {
+      uint32_t value = mValue.load(std::memory_order_relaxed);
+      mValue.store(aDecommitted ? (value | cMaskDecommitted) : (value & ~cMaskDecommitted), std::memory_order_relaxed);
+    }
+
+    /// Called without the lock, so the lock holder may change the header meanwhile.
+    /// @returns false if the block is free or waits in the remote free list already.
+    bool markRemote() noexcept {
+      uint32_t value = mValue.load(std::memory_order_relaxed);
+      bool result = true;
+      do {
+        result = (value & (cMaskFree | cMaskRemote)) == 0u;
+      } while(result && !mValue.compare_exchange_weak(value, value | cMaskRemote, std::memory_order_relaxed, std::memory_order_relaxed));
+      return result;
+    }
+
+    void clearRemote() noexcept {
+      mValue.fetch_and(~cMaskRemote, std::memory_order_relaxed);
+    }
+
+    /// Atomic, because other threads may try to free the same block meanwhile.
+    /// @returns false if the block was already in the requested state.
+    bool setCached(bool const aCached) noexcept {
+      uint32_t old = (aCached ? mValue.fetch_or(cMaskCached, std::memory_order_relaxed) : mValue.fetch_and(~cMaskCached, std::memory_order_relaxed));
+      return ((old & cMaskCached) != 0u) != aCached;
     }
   };
   static_assert(sizeof(BlockHeader) == sizeof(uint32_t), "Assures that BlockHeader is 4 bytes long.");
   static_assert(alignof(BlockHeader) == alignof(uint32_t), "Assures that BlockHeader has the alignment of uint32_t.");
 
+  typedef typename std::conditional<tConfig::cPositionIndependent, OffsetPointer<uint8_t>, uint8_t*>::type BlockLink;
+  typedef typename std::conditional<tConfig::cPositionIndependent, OffsetPointer<BlockLink>, BlockLink*>::type ListHeadsLink;
+  typedef typename std::conditional<tConfig::cPositionIndependent, OffsetPointer<BlockHeader>, BlockHeader*>::type HeadersLink;
+
+  /// Used in intrusive mode, placed right after the header of each free block, or at its start for cHeaderless.
+  class FreeLinks final {
+  public:
+    BlockLink mPrevious;
+    BlockLink mNext;
+  };
+
+  /// Relaxed atomics, because per-index locking updates them from several threads.
+  class Counters final {
+  public:
+    std::atomic<size_t>   mAllocations[cStatisticsIndexCount] = {};
+    std::atomic<size_t>   mDeallocations[cStatisticsIndexCount] = {};
+    std::atomic<size_t>   mSplits { 0u };
+    std::atomic<size_t>   mMerges { 0u };
+    std::atomic<size_t>   mFailures { 0u };
+    std::atomic<size_t>   mPeakUsed { 0u };
+    std::atomic<size_t>   mRequestedBytes { 0u };
+    std::atomic<size_t>   mGrantedBytes { 0u };
+    std::atomic<uint64_t> mLockNanoseconds { 0u };
+  };
+
+  /// Padded to a cache line to keep threads working on neighbouring indices from false sharing.
+  class LevelLock final {
+  public:
+    typename tConfig::InstanceLock mLock;
+
+  private:
+    uint8_t mPadding[cLevelLockSize - sizeof(typename tConfig::InstanceLock)];
+  };
+
+  /// Placed right after the block header of each slab, which is an ordinary block carved into
+  /// slots of one size class. The slabs of a class having free slots are doubly linked.
+  class Slab;
+  typedef typename std::conditional<tConfig::cPositionIndependent, OffsetPointer<Slab>, Slab*>::type SlabLink;
+
+  class Slab final {
+  public:
+    SlabLink mPrevious;
+    SlabLink mNext;
+    size_t mClass;
+    size_t mSlotCount;
+    size_t mFreeCount;
+    size_t mFree[cSlabBitmapWords]; // bit i tells if slot i is free
+    std::atomic<size_t> mRemote[tConfig::cRemoteFree ? cSlabBitmapWords : 1u]; // bit i tells if slot i waits in the remote free list
+  };
+
+  static constexpr size_t cSlabHeaderSize = (sizeof(Slab) + tAlignment - 1u) / tAlignment * tAlignment;
+  static_assert(!cSlabEnabled || tConfig::cSlabSize >= cSlabHeaderSize + 16u * cMaxSlotSize, "A slab must hold at least 16 slots of the largest class.");
+
   typedef std::set<uint8_t*, std::less<uint8_t*>, PoolAllocator<uint8_t*, FixedOccupier>> FreeSet;
   typedef PoolAllocator<uint8_t*, FixedOccupier>                                          FreeSetAllocator;
 
   bool              mExactAllocation;
-  size_t            mSetNodeSize;
+  size_t            mSetNodeSize = 0u;
   bool              mReady       = false;
   size_t            mBlockSize;
+  size_t            mBlockShift  = 0u; // log2(mBlockSize), used only for cPowerOfTwoBlockSize
   size_t            mFibonacciCount;
-  FreeSetAllocator* mAllocator;
-  FreeSet*          mFreeSets;
-  size_t*           mFibonaccis;
-  FibonacciCell*    mAllocationDirections;
+  FreeSetAllocator* mAllocator   = nullptr;
+  FreeSet*          mFreeSets    = nullptr;
+  ListHeadsLink     mFreeLists   = nullptr; // list heads in intrusive mode
+  HeadersLink       mHeaders     = nullptr; // one for each unit block for cHeaderless, valid at the block starts
+  std::atomic<size_t> mOccupied[cBitmapWords] = {}; // bit i tells if there is a free block of index i
+  mutable typename tConfig::InstanceLock mLock;
+  mutable LevelLock mLevelLocks[cLevelLockCount];  // used only for FibonacciLocking::cPerIndex
+  std::atomic<size_t> mUncoalesced[cUncoalescedCount] = {}; // blocks freed on each index since the last coalescing, for cLazyCoalescing
+  mutable Counters  mCounters; // only for cStatistics
+  SlabLink          mSlabs[cSlabClassCount] = {};         // slabs having free slots of each class
+  std::atomic<size_t> mSlabStarts[cSlabStartWords] = {}; // bit i tells if a slab block starts at mData + i * mBlockSize
+  std::atomic<size_t> mSlabUnits[cSlabStartWords] = {};  // bit i tells if mData + i * mBlockSize lies in a slab block
+  size_t            mSlabIndex   = 0u;                   // of the slab blocks
+  uint8_t*          mRecent[cRecentIndexCount][cRecentDepth] = {}; // ring of the blocks released on each index, for cReuse
+  size_t            mRecentTops[cRecentIndexCount] = {};           // the last one written
+  size_t            mRecentCounts[cRecentIndexCount] = {};         // valid entries below the top
+  mutable LevelLock mSlabLocks[cSlabLockCount];            // used only for FibonacciLocking::cPerIndex
   void*             mPool;
-  uint8_t*          mData;
-  size_t            mFreeSpace;
+  BlockLink         mData;
+  uint64_t          mSignature   = 0u;      // of the template parameters for cPositionIndependent, checked by attach
+  std::atomic<size_t> mRemoteFrees { 0u };  // head of the blocks freed while locked, 1 + offset from mData, 0 if empty
+  std::atomic<size_t> mFreeSpace;
 
 public:
+  typedef FibonacciStatistics<cMaxFibonacciCount> Statistics;
+
+  /// A block visited by the heap walk.
+  struct BlockInfo final {
+    void*  mStart;  // of the block, the payload of a used one starts getHeaderSize() bytes later unless over-aligned
+    size_t mIndex;
+    size_t mSize;   // including the header, if any
+    bool   mFree;
+  };
+
+  /// Visits every block in address order.
+  class BlockIterator final {
+  private:
+    FibonacciMemoryManager const* mManager;
+    uint8_t*                      mBlock;
+
+  public:
+    BlockIterator(FibonacciMemoryManager const * const aManager, uint8_t* const aBlock) noexcept : mManager(aManager), mBlock(aBlock) {
+    }
+
+    BlockInfo operator*() const noexcept {
+      BlockHeader const* header = mManager->getHeader(mBlock);
+      size_t index = header->getIndex();
+      return BlockInfo { mBlock, index, mManager->mBlockSize * cTables.mFibonaccis[index], header->isFree() };
+    }
+
+    BlockIterator& operator++() noexcept {
+      mBlock += mManager->mBlockSize * cTables.mFibonaccis[mManager->getHeader(mBlock)->getIndex()];
+      return *this;
+    }
+
+    bool operator==(BlockIterator const &aOther) const noexcept {
+      return mBlock == aOther.mBlock;
+    }
+
+    bool operator!=(BlockIterator const &aOther) const noexcept {
+      return mBlock != aOther.mBlock;
+    }
+  };
+
+  class Blocks final {
+  private:
+    FibonacciMemoryManager const* mManager;
+
+  public:
+    Blocks(FibonacciMemoryManager const * const aManager) noexcept : mManager(aManager) {
+    }
+
+    BlockIterator begin() const noexcept {
+      return BlockIterator(mManager, mManager->mData);
+    }
+
+    BlockIterator end() const noexcept {
+      return BlockIterator(mManager, mManager->mData + mManager->mBlockSize * cTables.mFibonaccis[mManager->mFibonacciCount - 1u]);
+    }
+  };
+
+  /// Layout of dump(), all fields little endian.
+  static constexpr uint32_t cDumpMagic      = 0x48424946u; // "FIBH"
+  static constexpr uint32_t cDumpVersion    = 2u;          // 1 had the alignment in place of the header size
+  static constexpr size_t   cDumpHeaderSize = 40u;         // magic, version, D, N as uint32, block size, header size, block count as uint64
+  static constexpr uint32_t cDumpFreeBit    = 1u << 31u;   // in the uint32 of each block after the N uint64 Fibonacci numbers
+
+  static constexpr uint64_t cImageMagic     = 0x4950424946u; // "FIBPI"
+
   FibonacciMemoryManager(void* aMemory, bool const aExactAllocation);
   
   FibonacciMemoryManager(bool const aExactAllocation) : FibonacciMemoryManager(reinterpret_cast<void*>(tMemory), aExactAllocation) {
   }
 
+  /// Resumes a heap built by the constructor with cPositionIndependent, which holds no absolute addresses,
+  /// so it may be mapped anywhere, for example from a file mapped again. Takes constant time.
+  /// Unless aShared, the heap must not be used by anyone else meanwhile, and its locks are reset.
+  /// If aShared, other processes may be using it through their own mappings, see FibonacciSharedMemory.h.
+  /// Calls tInterface::badAlloc() if aMemory doesn't start with a heap of the same template parameters.
+  /// @returns the manager at aMemory, or nullptr if badAlloc() returns.
+  static FibonacciMemoryManager* attach(void* aMemory, bool const aShared = false);
+
   size_t getFibonacciCount() const noexcept {
     return mFibonacciCount;
   }
 
   size_t getFibonacci(size_t const aIndex) const noexcept {
-    return mFibonaccis[std::min<size_t>(aIndex, mFibonacciCount - 1u)];
+    return cTables.mFibonaccis[std::min<size_t>(aIndex, mFibonacciCount - 1u)];
   }
 
   size_t getMaxFibonacci() const noexcept {
-    return mFibonaccis[mFibonacciCount - 1u];
+    return cTables.mFibonaccis[mFibonacciCount - 1u];
   }
 
   size_t getFreeSpace() const noexcept {
-    return mFreeSpace;
+    return mFreeSpace.load(std::memory_order_relaxed);
   }
 
   size_t getMaxUserBlockSize() const noexcept {
@@ -183,431 +787,3661 @@ public:
     return tAlignment;
   }
 
-  void* allocate(size_t const aSize);
-  void deallocate(void* const aPointer);
-
-  bool isCorrectEmpty() const noexcept;
-
-private:
-  void* alignTo(void* const aPointer, size_t const aAlign) {
-    void* pointer = aPointer;
-    size_t bufLen = aAlign * 2u;
-    return std::align(aAlign, 1u, pointer, bufLen);
+  /// @returns the bytes before each payload, 0 for cHeaderless.
+  static constexpr size_t getHeaderSize() noexcept {
+    return cHeaderSize;
   }
 
-  void* alignToMax(void* const aPointer) {
-    return alignTo(aPointer, alignof(std::max_align_t));
+  /// @returns the largest request served from slabs, 0 if they are disabled.
+  static constexpr size_t getMaxSlotSize() noexcept {
+    return cMaxSlotSize;
   }
 
-  static size_t calculateFibonaccis(size_t* const aResult, size_t const aMaxCount, size_t const aMaxValue) noexcept;
-  size_t calculateTotalHeaderSize(size_t const * const aFibonaccis, size_t const aFibonacciCount) noexcept;
-  void initInternalData(void* aMemory) noexcept;
-  void fillAllocationDirections() noexcept;
+  /// @returns the smallest index of blocks able to hold aSize bytes, or getFibonacciCount() if there is none.
+  size_t getSuitableIndex(size_t const aSize) const noexcept;
+
+  /// @returns the index of the allocated block of aPointer, or getFibonacciCount() if aPointer is not such a block,
+  /// is a slot or is an over-aligned one not right after the block header.
+  size_t getBlockIndex(void const * const aPointer) const noexcept;
 
-  FibonacciCell& allocationDirectionAt(size_t const aIndexBig, size_t const aIndexSmall) noexcept {
-    return mAllocationDirections[aIndexBig * mFibonacciCount + aIndexSmall];
+  /// Marks or unmarks a block kept allocated by a front end for reuse, like the blocks in the thread caches of NewDelete.
+  /// aPointer must be one for which getBlockIndex gives a valid index.
+  /// @returns false if the block was already in the requested state, which is a double free when marking.
+  bool setCached(void* const aPointer, bool const aCached) noexcept {
+    return getHeader(static_cast<uint8_t*>(aPointer) - cHeaderSize)->setCached(aCached);
   }
 
+  /// Like malloc_usable_size, reads only the header of the block of aPointer, which must stay allocated meanwhile.
+  /// @returns the bytes usable from aPointer until the end of its slot or block, or 0 if it was not allocated here.
+  size_t getUsableSize(void const * const aPointer) const noexcept;
+
   size_t getUserBlockSize(size_t const aFibonacciIndex) const noexcept {
-    return mBlockSize * mFibonaccis[aFibonacciIndex] - tAlignment;
+    return mBlockSize * cTables.mFibonaccis[aFibonacciIndex] - cHeaderSize;
   }
-};
 
-template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory = 0u>
-class NewDelete final {
-private: 
-  static FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference>* sFibonacci; // could be inline for c++17
+  /// @returns true if aPointer points into the blocks served by this instance.
+  bool contains(void const * const aPointer) const noexcept {
+    uint8_t const * const pointer = reinterpret_cast<uint8_t const*>(aPointer);
+    return pointer >= mData && pointer < mData + mBlockSize * cTables.mFibonaccis[mFibonacciCount - 1u];
+  }
 
-  template<typename tClass, typename ...tParameters>
-  struct Wrapper final {
-  public:
-    tClass mPayload;
+  void* allocate(size_t const aSize);
 
-    Wrapper(tParameters... aParameters) : mPayload(aParameters...) {
-    }
+  /// Like allocate, but returns nullptr on failure instead of calling badAlloc.
+  void* tryAllocate(size_t const aSize);
 
-    void* operator new(size_t aSize) {
-      return sFibonacci->allocate(aSize);
-    }
+  /// Allocates aSize bytes aligned to aAlignment, which must be a power of 2 and may exceed tAlignment.
+  /// Splits towards the child in which the payload fits on the boundary. If the payload can't land
+  /// right after the block header, a shifted header before it tells where the block starts.
+  void* allocateAligned(size_t const aSize, size_t const aAlignment);
 
-    void* operator new[](size_t aSize) {
-      return sFibonacci->allocate(aSize);
-    }
+  /// Like allocateAligned, but returns nullptr on failure instead of calling badAlloc.
+  void* tryAllocateAligned(size_t const aSize, size_t const aAlignment);
 
-    void operator delete(void* aPointer) {
-      sFibonacci->deallocate(aPointer);
-    }
+  void deallocate(void* const aPointer);
 
-    void operator delete[](void* aPointer) {
-      sFibonacci->deallocate(aPointer);
-    }
-  };
+  /// Sized deallocation, aSize must not exceed the size the block was allocated or last reallocated with.
+  /// In headerless mode a size no slot can hold goes to the table entry without looking up the slab.
+  /// A slot or block too small for aSize is rejected like a double free.
+  void deallocate(void* const aPointer, size_t const aSize);
 
+  /// Resizes the block of aPointer keeping its contents like realloc. It grows in place by merging
+  /// with free right buddies up the tree, and shrinks in place by splitting off right children.
+  /// Only if growing in place is impossible, it allocates a new block, copies and frees the old one.
+  /// A slab slot is kept while aSize fits in it, otherwise it is moved the same way.
+  /// A nullptr aPointer means allocate, 0 aSize means deallocate. Calls badAlloc on failure, leaving the old block intact.
+  /// An over-aligned block keeps its alignment only when resized in place.
+  /// @returns the possibly new pointer.
+  void* reallocate(void* const aPointer, size_t const aSize);
+
+  /// Like reallocate for a non-nullptr aPointer and a non-zero aSize, but returns nullptr instead of calling badAlloc,
+  /// so a front end can move the block elsewhere. The caller tells an invalid aPointer from a full heap.
+  void* tryReallocate(void* const aPointer, size_t const aSize) noexcept;
+
+  /// Allocates at most aCount blocks of aSize bytes into aPointers under one lock.
+  /// Larger free blocks are split into as many blocks as needed in one pass, giving increasing addresses.
+  /// Does not call badAlloc.
+  /// @returns the number of blocks allocated.
+  size_t allocateBulk(size_t const aSize, size_t const aCount, void** const aPointers);
+
+  /// Deallocates the non-null pointers under one lock, in increasing address order
+  /// in chunks of cBulkSortChunk, so buddies freed together merge in one sweep.
+  void deallocateBulk(void* const * const aPointers, size_t const aCount);
+
+  /// Frees the blocks waiting in the remote free list, merges all free buddies, which deallocation
+  /// has left apart in lazy coalescing mode, and releases the slabs having all their slots free. Does nothing otherwise.
+  void coalesce() noexcept;
+
+  /// In lazy coalescing mode, with slabs or remote free, coalesce() must be called before.
+  bool isCorrectEmpty() const noexcept;
+
+  /// Calls aFunction holding the lock if no block is allocated, so none can be allocated or freed meanwhile.
+  /// In lazy coalescing mode, with slabs or remote free, coalesce() must be called before.
+  /// @returns true if aFunction was called.
+  template<typename tFunction>
+  bool callIfEmpty(tFunction aFunction) noexcept;
+
+  /// @returns the counters collected since construction, all zero unless FibonacciConfig::cStatistics.
+  Statistics getStatistics() const noexcept;
+
+  /// @returns a range for visiting every block in address order using BlockIterator.
+  /// Not thread safe, the caller must keep the manager unchanged meanwhile.
+  Blocks getBlocks() const noexcept {
+    return Blocks(this);
+  }
+
+  /// Writes a binary snapshot of the heap walk and the Fibonacci numbers for offline analysis,
+  /// see the dump constants for the layout. Writes nothing if aSize is too small.
+  /// @returns the size of the snapshot, may be larger than aSize.
+  size_t dump(void* const aBuffer, size_t const aSize) const noexcept;
+
+  /// Finds the largest node of the buddy tree below the root, which has used blocks, all accepted by aMovable for their
+  /// payloads, at most 1 / aDivisor of its bytes used, and not more bytes than getFreeSpace(), so evacuating it may free it whole.
+  /// The node must be larger than any free block, so evacuating it is worth splitting those.
+  /// Of the nodes of the same index, the least used one wins. Then allocates at most aCapacity free blocks of the node into
+  /// aReserved, so other allocations go elsewhere while it is evacuated. aMovable is not called after the first one is written.
+  /// Takes one walk of the heap under the lock.
+  /// @returns the number of blocks reserved, and the node in [aStart, aEnd), or nullptr in both if no node qualifies.
+  template<typename tMovable>
+  size_t reserveSparseNode(tMovable const& aMovable, size_t const aDivisor, void** const aReserved, size_t const aCapacity, void*& aStart, void*& aEnd) noexcept;
+
+private:
+  void* alignTo(void* const aPointer, size_t const aAlign) {
+    void* pointer = aPointer;
+    size_t bufLen = aAlign * 2u;
+    return std::align(aAlign, 1u, pointer, bufLen);
+  }
+
+  void* alignToMax(void* const aPointer) {
+    return alignTo(aPointer, alignof(std::max_align_t));
+  }
+
+  static uint8_t* writeLittleEndian(uint8_t* const aTo, uint64_t const aValue, size_t const aByteCount) noexcept {
+    for(size_t i = 0u; i < aByteCount; ++i) {
+      aTo[i] = static_cast<uint8_t>(aValue >> (i * 8u));
+    }
+    return aTo + aByteCount;
+  }
+
+  static uint8_t* alignUp(uint8_t* const aPointer, size_t const aAlign) noexcept {
+    return reinterpret_cast<uint8_t*>((reinterpret_cast<uintptr_t>(aPointer) + aAlign - 1u) & ~static_cast<uintptr_t>(aAlign - 1u));
+  }
+
+  void lock() const noexcept {
+    if(tConfig::cLocking == FibonacciLocking::cInterface) {
+      auto start = startLockTimer();
+      tInterface::lock();
+      stopLockTimer(start);
+    }
+    else if(tConfig::cLocking == FibonacciLocking::cInstance) {
+      auto start = startLockTimer();
+      mLock.lock();
+      stopLockTimer(start);
+    }
+    else { // the indices are locked one by one using lockLevel
+    }
+  }
+
+  void unlock() const noexcept {
+    if(tConfig::cLocking == FibonacciLocking::cInterface) {
+      tInterface::unlock();
+    }
+    else if(tConfig::cLocking == FibonacciLocking::cInstance) {
+      mLock.unlock();
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// Locks the free list of the given index for FibonacciLocking::cPerIndex, does nothing otherwise.
+  void lockLevel(size_t const aIndex) const noexcept {
+    if(cPerIndexLocking) {
+      auto start = startLockTimer();
+      mLevelLocks[aIndex].mLock.lock();
+      stopLockTimer(start);
+    }
+    else { // nothing to do
+    }
+  }
+
+  void unlockLevel(size_t const aIndex) const noexcept {
+    if(cPerIndexLocking) {
+      mLevelLocks[aIndex].mLock.unlock();
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// Locks two different indices in increasing order to avoid deadlock.
+  void lockLevels(size_t const aIndex1, size_t const aIndex2) const noexcept {
+    lockLevel(std::min(aIndex1, aIndex2));
+    lockLevel(std::max(aIndex1, aIndex2));
+  }
+
+  void unlockLevels(size_t const aIndex1, size_t const aIndex2) const noexcept {
+    unlockLevel(std::max(aIndex1, aIndex2));
+    unlockLevel(std::min(aIndex1, aIndex2));
+  }
+
+  static std::chrono::steady_clock::time_point startLockTimer() noexcept {
+    return tConfig::cStatistics ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+  }
+
+  void stopLockTimer(std::chrono::steady_clock::time_point const aStart) const noexcept {
+    if(tConfig::cStatistics) {
+      auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - aStart);
+      mCounters.mLockNanoseconds.fetch_add(static_cast<uint64_t>(elapsed.count()), std::memory_order_relaxed);
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// Counts a block of aIndex given for aRequested bytes, called after its space is accounted.
+  void countAllocation(size_t const aIndex, size_t const aRequested) noexcept {
+    if(tConfig::cStatistics) {
+      mCounters.mAllocations[aIndex].fetch_add(1u, std::memory_order_relaxed);
+      mCounters.mRequestedBytes.fetch_add(aRequested, std::memory_order_relaxed);
+      mCounters.mGrantedBytes.fetch_add(getUserBlockSize(aIndex), std::memory_order_relaxed);
+      size_t used = getMaxUserBlockSize() - getFreeSpace();
+      size_t peak = mCounters.mPeakUsed.load(std::memory_order_relaxed);
+      while(used > peak && !mCounters.mPeakUsed.compare_exchange_weak(peak, used, std::memory_order_relaxed)) {
+      }
+    }
+    else { // nothing to do
+    }
+  }
+
+  void countDeallocation(size_t const aIndex) noexcept {
+    if(tConfig::cStatistics) {
+      mCounters.mDeallocations[aIndex].fetch_add(1u, std::memory_order_relaxed);
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// For the counters without index.
+  void countEvent(std::atomic<size_t>& aCounter) noexcept {
+    if(tConfig::cStatistics) {
+      aCounter.fetch_add(1u, std::memory_order_relaxed);
+    }
+    else { // nothing to do
+    }
+  }
+
+  void increaseFreeSpace(size_t const aAmount) noexcept {
+    if(cPerIndexLocking) {
+      mFreeSpace.fetch_add(aAmount, std::memory_order_relaxed);
+    }
+    else {
+      mFreeSpace.store(mFreeSpace.load(std::memory_order_relaxed) + aAmount, std::memory_order_relaxed);
+    }
+  }
+
+  void decreaseFreeSpace(size_t const aAmount) noexcept {
+    if(cPerIndexLocking) {
+      mFreeSpace.fetch_sub(aAmount, std::memory_order_relaxed);
+    }
+    else {
+      mFreeSpace.store(mFreeSpace.load(std::memory_order_relaxed) - aAmount, std::memory_order_relaxed);
+    }
+  }
+
+  size_t calculateTotalHeaderSize(size_t const aFibonacciCount) noexcept;
+
+  size_t calculateBlockSize(size_t const aHeaderSize, size_t const aFibonacciCount) const noexcept {
+    size_t result = ((tMemorySize - aHeaderSize) / cTables.mFibonaccis[aFibonacciCount - 1u]) & ~(tAlignment - 1u);
+    if(tConfig::cPowerOfTwoBlockSize && result > 0u) {
+      result = static_cast<size_t>(1u) << getHighestSetBit(result);
+    }
+    else { // nothing to do
+    }
+    return result;
+  }
+
+  void initInternalData(void* aMemory) noexcept;
+
+  static uint64_t getImageSignature() noexcept {
+    return cImageMagic ^ (static_cast<uint64_t>(sizeof(FibonacciMemoryManager)) << 40u) ^ (static_cast<uint64_t>(tMemorySize) << 8u)
+      ^ (static_cast<uint64_t>(tMinimalBlockSize) << 24u) ^ (static_cast<uint64_t>(tAlignment) << 48u) ^ (static_cast<uint64_t>(tFibonacciIndexDifference) << 56u);
+  }
+
+  void resetLocks() noexcept;
+
+  FibonacciCell const& allocationDirectionAt(size_t const aIndexBig, size_t const aIndexSmall) const noexcept {
+    return cTables.mDirections[mExactAllocation ? 1u : 0u][aIndexBig * cMaxFibonacciCount + aIndexSmall];
+  }
+
+  BlockHeader* getHeader(void* const aBlock) const noexcept {
+    return tConfig::cHeaderless ? mHeaders + getUnit(static_cast<uint8_t const*>(aBlock)) : static_cast<BlockHeader*>(aBlock);
+  }
+
+  /// @returns the index of the unit block containing aPointer, counted from mData.
+  size_t getUnit(uint8_t const * const aPointer) const noexcept {
+    return tConfig::cPowerOfTwoBlockSize
+      ? static_cast<size_t>(aPointer - mData) >> mBlockShift
+      : static_cast<size_t>(aPointer - mData) / mBlockSize;
+  }
+
+  static FreeLinks* getLinks(uint8_t* const aBlock) noexcept {
+    return reinterpret_cast<FreeLinks*>(aBlock + cHeaderSize);
+  }
+
+  /// Exact only if the caller holds the lock of aIndex, otherwise just a hint.
+  bool hasFree(size_t const aIndex) const noexcept {
+    return (mOccupied[aIndex / cBitsPerWord].load(std::memory_order_relaxed) & (static_cast<size_t>(1u) << (aIndex % cBitsPerWord))) != 0u;
+  }
+
+  /// Different indices share a word, so the update must be atomic for per-index locking.
+  void setOccupied(size_t const aIndex, bool const aOccupied) noexcept {
+    size_t const bit = static_cast<size_t>(1u) << (aIndex % cBitsPerWord);
+    std::atomic<size_t>& word = mOccupied[aIndex / cBitsPerWord];
+    if(cPerIndexLocking) {
+      if(aOccupied) {
+        word.fetch_or(bit, std::memory_order_relaxed);
+      }
+      else {
+        word.fetch_and(~bit, std::memory_order_relaxed);
+      }
+    }
+    else {
+      size_t value = word.load(std::memory_order_relaxed);
+      word.store(aOccupied ? (value | bit) : (value & ~bit), std::memory_order_relaxed);
+    }
+  }
+
+  /// @returns the smallest index >= aFrom having a free block and its bit set in aMask, or mFibonacciCount if none.
+  size_t findFree(size_t const aFrom, size_t const * const aMask = nullptr) const noexcept;
+
+  /// Pops a free block of the smallest index >= aFrom having its bit set in aMask.
+  /// Retries with higher indices if an other thread has emptied the found list meanwhile.
+  /// @returns the block and its index in aIndex, or nullptr if none.
+  uint8_t* takeFree(size_t const aFrom, size_t const * const aMask, size_t& aIndex) noexcept;
+
+  uint8_t* popFree(size_t const aIndex) noexcept;
+  void pushFree(uint8_t* const aBlock, size_t const aIndex) noexcept;
+  void unlinkFree(uint8_t* const aBlock, size_t const aIndex) noexcept;
+
+  /// Removes the block from the free ones if it is a whole free block of the given index.
+  /// Relies only on its header, so it takes O(1) for intrusive lists.
+  bool removeFreeBuddy(uint8_t* const aBlock, size_t const aIndex) noexcept;
+
+  bool isInBlockArea(uint8_t const * const aPointer) const noexcept {
+    return reinterpret_cast<uintptr_t>(aPointer) % tAlignment == 0u && aPointer >= mData && aPointer < mData + mBlockSize * cTables.mFibonaccis[mFibonacciCount - 1u];
+  }
+
+  /// @returns the block start of a pointer returned by allocate or allocateAligned, or nullptr if it can't be one.
+  uint8_t* getBlockStart(void const * const aPointer) const noexcept {
+    return getBlockStart(const_cast<uint8_t*>(reinterpret_cast<uint8_t const*>(aPointer)), std::integral_constant<bool, tConfig::cHeaderless>());
+  }
+
+  uint8_t* getBlockStart(uint8_t* const aPointer, std::false_type) const noexcept {
+    uint8_t* blockStart = aPointer - tAlignment;
+    if(isInBlockArea(blockStart) && getHeader(blockStart)->isShifted()) {
+      blockStart -= getHeader(blockStart)->getIndex() * tAlignment;
+    }
+    else { // nothing to do
+    }
+    return isInBlockArea(blockStart) ? blockStart : nullptr;
+  }
+
+  /// Only block starts and over-aligned payloads in other than the first unit of their block have
+  /// a valid table entry, so a payload in the first unit belongs to the block starting there.
+  uint8_t* getBlockStart(uint8_t* const aPointer, std::true_type) const noexcept {
+    uint8_t* blockStart = nullptr;
+    if(isInBlockArea(aPointer)) {
+      size_t unit = getUnit(aPointer);
+      BlockHeader const* header = mHeaders + unit;
+      blockStart = (header->isShifted() ? aPointer - header->getIndex() * tAlignment : mData + unit * mBlockSize);
+    }
+    else { // nothing to do
+    }
+    return blockStart;
+  }
+
+  /// Tells getBlockStart where the block of an over-aligned payload starts.
+  void markShifted(uint8_t* const aBlock, uint8_t* const aPayload) noexcept {
+    size_t distance = static_cast<size_t>(aPayload - cHeaderSize - aBlock) / tAlignment;
+    if(!tConfig::cHeaderless) {
+      getHeader(aPayload - tAlignment)->setShifted(distance);
+    }
+    else if(getUnit(aPayload) != getUnit(aBlock)) {
+      getHeader(aPayload)->setShifted(distance);
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// Checks aPointer as far as possible without the lock, which is the address, aSize if not 0, and that the block or slot
+  /// is neither free nor waiting already. If so, marks it and pushes it on the lock-free list, linking through its first word.
+  /// A slot freed twice is caught only when draining the list, because its free bit can't be read without the lock.
+  /// @returns false for a pointer rejected.
+  bool pushRemoteFree(void* const aPointer, size_t const aSize) noexcept;
+
+  /// Tells if pushRemoteFree has marked aPointer in aSlab or in the block at aBlockStart, whichever is not nullptr.
+  bool isRemote(Slab const* const aSlab, uint8_t* const aBlockStart, void const * const aPointer) const noexcept;
+
+  /// Clears the mark of pushRemoteFree before draining aPointer, the caller must hold the lock.
+  void clearRemote(void const * const aPointer) noexcept;
+
+  /// @returns the bit of the slot of aPointer in the bitmap words of aSlab, or cSlabBitmapWords * cBitsPerWord if it is not a slot start.
+  size_t getSlot(Slab const* const aSlab, void const * const aPointer) const noexcept {
+    size_t offset = static_cast<size_t>(static_cast<uint8_t const*>(aPointer) - reinterpret_cast<uint8_t const*>(aSlab)) - cSlabHeaderSize; // wraps around for the header
+    size_t slotSize = getSlotSize(aSlab->mClass);
+    return offset % slotSize == 0u && offset / slotSize < aSlab->mSlotCount ? offset / slotSize : cSlabBitmapWords * cBitsPerWord;
+  }
+
+  void linkRemoteFree(void* const aPointer) noexcept {
+    size_t offset = static_cast<size_t>(static_cast<uint8_t*>(aPointer) - mData) + 1u;
+    size_t head = mRemoteFrees.load(std::memory_order_relaxed);
+    do {
+      *static_cast<size_t*>(aPointer) = head;
+    } while(!mRemoteFrees.compare_exchange_weak(head, offset, std::memory_order_release, std::memory_order_relaxed));
+  }
+
+  /// Deallocates the pointers pushed by pushRemoteFree, the caller must hold the lock.
+  /// @returns false if any of them was a double free.
+  bool drainRemoteFrees() noexcept;
+
+  /// Puts a block freed by the application or merged from such blocks in the free list of its index.
+  /// Its whole pages are decommitted before if its index is large enough and they are not decommitted yet.
+  void pushReleased(uint8_t* const aBlock, size_t const aIndex) noexcept {
+    decommit(aBlock, aIndex, std::integral_constant<bool, cDecommitEnabled>());
+    pushFree(aBlock, aIndex);
+    rememberReleased(aBlock, aIndex, std::integral_constant<bool, cReuseEnabled>());
+  }
+
+  void rememberReleased(uint8_t* const, size_t const, std::false_type) noexcept { // nothing to do
+  }
+
+  /// Overwrites the oldest entry if the ring is full. The entries are checked when used, because the blocks may be taken or merged since.
+  void rememberReleased(uint8_t* const aBlock, size_t const aIndex, std::true_type) noexcept {
+    mRecentTops[aIndex] = (mRecentTops[aIndex] + 1u) % cRecentDepth;
+    mRecent[aIndex][mRecentTops[aIndex]] = aBlock;
+    mRecentCounts[aIndex] = (mRecentCounts[aIndex] < cRecentDepth ? mRecentCounts[aIndex] + 1u : cRecentDepth);
+  }
+
+  typename FreeSet::iterator findRecent(size_t const aIndex, std::false_type) noexcept {
+    return mFreeSets[aIndex].end();
+  }
+
+  /// @returns the free block chosen by cReuse using the remembered ones, or the end of the free set if none of them helps.
+  typename FreeSet::iterator findRecent(size_t const aIndex, std::true_type) noexcept;
+
+  void decommit(uint8_t* const, size_t const, std::false_type) noexcept { // nothing to do
+  }
+
+  void decommit(uint8_t* const aBlock, size_t const aIndex, std::true_type) noexcept {
+    if(aIndex >= tConfig::cDecommitIndex && !getHeader(aBlock)->isDecommitted()) {
+      uint8_t* start;
+      uint8_t* end;
+      getDecommitRange(aBlock, aIndex, start, end);
+      if(start < end) {
+        tInterface::decommit(start, static_cast<size_t>(end - start));
+        getHeader(aBlock)->setDecommitted(true);
+      }
+      else { // nothing to do
+      }
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// Gives the whole pages of a free block, which may be empty if aStart is not below aEnd. The header and the links stay.
+  void getDecommitRange(uint8_t* const aBlock, size_t const aIndex, uint8_t*& aStart, uint8_t*& aEnd) const noexcept {
+    aStart = alignUp(aBlock + cHeaderSize + sizeof(FreeLinks), tConfig::cPageSize);
+    aEnd = reinterpret_cast<uint8_t*>(reinterpret_cast<uintptr_t>(aBlock + mBlockSize * cTables.mFibonaccis[aIndex]) & ~static_cast<uintptr_t>(tConfig::cPageSize - 1u));
+  }
+
+  /// Passes the decommitted state of a split free block on to those children whose whole pages lie inside the range released for it.
+  /// The header of the right child is written since, but that page is outside the ranges of both children.
+  void inheritDecommitted(uint8_t* const aParent, size_t const aParentIndex, bool const aDecommitted) noexcept {
+    if(cDecommitEnabled && aDecommitted) {
+      size_t leftIndex = aParentIndex - tFibonacciIndexDifference - 1u;
+      uint8_t* children[2u] = { aParent, aParent + mBlockSize * cTables.mFibonaccis[leftIndex] };
+      size_t childIndices[2u] = { leftIndex, aParentIndex - 1u };
+      uint8_t* parentStart;
+      uint8_t* parentEnd;
+      getDecommitRange(aParent, aParentIndex, parentStart, parentEnd);
+      for(size_t i = 0u; i < 2u; ++i) {
+        uint8_t* start;
+        uint8_t* end;
+        getDecommitRange(children[i], childIndices[i], start, end);
+        getHeader(children[i])->setDecommitted(start < end && parentStart <= start && end <= parentEnd);
+      }
+    }
+    else { // nothing to do
+    }
+  }
+
+  void mergeDecommitted(uint8_t* const, size_t const, bool const, bool const, std::false_type) noexcept { // nothing to do
+  }
+
+  /// Called on a block just merged from two free children. If any of them was decommitted, the block will be decommitted
+  /// anyway as its index is larger, so only its pages outside the ranges of the decommitted children are given back now,
+  /// like the one keeping the header of the former right child. Otherwise it stays committed for pushReleased.
+  void mergeDecommitted(uint8_t* const aParent, size_t const aParentIndex, bool const aLeftDecommitted, bool const aRightDecommitted, std::true_type) noexcept {
+    if(aLeftDecommitted || aRightDecommitted) {
+      size_t leftIndex = aParentIndex - tFibonacciIndexDifference - 1u;
+      uint8_t* children[2u] = { aParent, aParent + mBlockSize * cTables.mFibonaccis[leftIndex] };
+      size_t childIndices[2u] = { leftIndex, aParentIndex - 1u };
+      bool decommitted[2u] = { aLeftDecommitted, aRightDecommitted };
+      uint8_t* from;     // the first page which may be still committed
+      uint8_t* parentEnd;
+      getDecommitRange(aParent, aParentIndex, from, parentEnd);
+      for(size_t i = 0u; i < 2u; ++i) {
+        if(decommitted[i]) {
+          uint8_t* start;
+          uint8_t* end;
+          getDecommitRange(children[i], childIndices[i], start, end);
+          if(from < start) {
+            tInterface::decommit(from, static_cast<size_t>(start - from));
+          }
+          else { // nothing to do
+          }
+          from = std::max(from, end);
+        }
+        else { // nothing to do
+        }
+      }
+      if(from < parentEnd) {
+        tInterface::decommit(from, static_cast<size_t>(parentEnd - from));
+      }
+      else { // nothing to do
+      }
+      getHeader(aParent)->setDecommitted(true);
+    }
+    else { // nothing to do
+    }
+  }
+
+  static size_t getSlotSize(size_t const aSlabClass) noexcept {
+    return (aSlabClass + 1u) * tAlignment;
+  }
+
+  /// @returns the slab containing aPointer, or nullptr if it is not in a slab, so it can't be a slot.
+  /// Only pointers in slab units look for the last slab start before them.
+  Slab* findSlab(void const * const aPointer) const noexcept;
+
+  /// For the sized deallocation. In headerless mode a size above cMaxSlotSize skips the slab bitmaps if aPointer
+  /// starts a unit with an unshifted table entry: such an entry starts a block or is marked free, because the table
+  /// starts all free and merging marks the entries it leaves behind, so a slot passed with a wrong size is still rejected.
+  Slab* findSlab(void const * const aPointer, size_t const aSize) const noexcept {
+    uint8_t const* pointer = static_cast<uint8_t const*>(aPointer);
+    bool const skip = tConfig::cHeaderless && aSize > cMaxSlotSize && isInBlockArea(pointer) &&
+                      mData + getUnit(pointer) * mBlockSize == pointer && !(mHeaders + getUnit(pointer))->isShifted();
+    return skip ? nullptr : findSlab(aPointer);
+  }
+
+  /// Sets or clears aCount bits from aFirst. Slabs of different classes may be created and released
+  /// in parallel in per-index locking, so the words are changed atomically.
+  static void setSlabBits(std::atomic<size_t>* const aBitmap, size_t const aFirst, size_t const aCount, bool const aSet) noexcept;
+
+  void markSlab(Slab* const aSlab, bool const aSet) noexcept;
+
+  /// Locks the slabs of the given class for FibonacciLocking::cPerIndex, does nothing otherwise, because lock() covers them.
+  void lockSlabClass(size_t const aSlabClass) const noexcept {
+    if(cPerIndexLocking) {
+      auto start = startLockTimer();
+      mSlabLocks[aSlabClass].mLock.lock();
+      stopLockTimer(start);
+    }
+    else { // nothing to do
+    }
+  }
+
+  void unlockSlabClass(size_t const aSlabClass) const noexcept {
+    if(cPerIndexLocking) {
+      mSlabLocks[aSlabClass].mLock.unlock();
+    }
+    else { // nothing to do
+    }
+  }
+
+  void linkSlab(Slab* const aSlab) noexcept {
+    aSlab->mPrevious = nullptr;
+    aSlab->mNext = mSlabs[aSlab->mClass];
+    if(aSlab->mNext != nullptr) {
+      aSlab->mNext->mPrevious = aSlab;
+    }
+    else { // nothing to do
+    }
+    mSlabs[aSlab->mClass] = aSlab;
+  }
+
+  void unlinkSlab(Slab* const aSlab) noexcept {
+    if(aSlab->mPrevious != nullptr) {
+      aSlab->mPrevious->mNext = aSlab->mNext;
+    }
+    else {
+      mSlabs[aSlab->mClass] = aSlab->mNext;
+    }
+    if(aSlab->mNext != nullptr) {
+      aSlab->mNext->mPrevious = aSlab->mPrevious;
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// Gives the slab back as an ordinary block, the caller must have unlinked it.
+  void releaseSlab(Slab* const aSlab) noexcept {
+    markSlab(aSlab, false);
+    deallocateInternal(aSlab);
+  }
+
+  // These expect the caller to hold the lock, and lock the slab class themselves.
+  void* allocateSlot(size_t const aSize) noexcept;
+  bool freeSlot(Slab* const aSlab, void* const aPointer) noexcept;
+
+  /// Releases the slabs having all their slots free, which are kept to avoid creating and releasing a slab on every call.
+  void releaseSpareSlabs() noexcept;
+
+  /// Puts a block whose buddy is not free in the free list of its index, and accounts its space.
+  void releaseBlock(uint8_t* const aBlock, size_t const aIndex) noexcept {
+    lockLevel(aIndex);
+    pushFree(aBlock, aIndex);
+    unlockLevel(aIndex);
+    increaseFreeSpace(getUserBlockSize(aIndex));
+  }
+
+  bool fitsAligned(uint8_t* const aBlock, size_t const aIndex, size_t const aSize, size_t const aAlignment) const noexcept {
+    return alignUp(aBlock + cHeaderSize, aAlignment) + aSize <= aBlock + mBlockSize * cTables.mFibonaccis[aIndex];
+  }
+
+  // These expect the caller to hold the lock.
+  void* allocateInternal(size_t const aSize) noexcept;
+  void* allocateAlignedInternal(size_t const aSize, size_t const aAlignment) noexcept;
+  uint8_t* allocateBlock(size_t const aSmallestSuitableIndex) noexcept;
+
+  /// Pops the free block allocateBlock would split for the given index.
+  /// @returns the block and its index in aIndex, or nullptr if none.
+  uint8_t* selectBlock(size_t const aSmallestSuitableIndex, size_t& aIndex) noexcept;
+
+  /// Splits aBlock depth first into at most aCount blocks suitable for aSmallestSuitableIndex,
+  /// and puts the rest into the free lists.
+  /// @returns the number of pointers written to aPointers.
+  size_t splitBulk(uint8_t* const aBlock, size_t const aSmallestSuitableIndex, size_t const aCount, void** const aPointers) noexcept;
+
+  /// aSize is 0 if unknown.
+  bool deallocateInternal(void* const aPointer, size_t const aSize = 0u) noexcept;
+
+  /// Merges the block with its free right buddies until it is suitable for aSmallestSuitableIndex.
+  /// Checks first if it is possible at all, to leave the block intact otherwise.
+  /// @returns true if the block is now suitable.
+  bool growInPlace(uint8_t* const aBlockStart, size_t const aSmallestSuitableIndex) noexcept;
+
+  /// Splits off the right children of the block while the left one is still suitable for aSmallestSuitableIndex.
+  void shrinkInPlace(uint8_t* const aBlockStart, size_t const aSmallestSuitableIndex) noexcept;
+  void freeBlock(uint8_t* const aBlockStart) noexcept;
+
+  /// Puts the block in its free list without coalescing, and coalesces all if the watermark is crossed.
+  void deferBlock(uint8_t* const aBlockStart) noexcept;
+
+  /// Merges the free buddies in one pass over the indices from the lowest one having deferred blocks.
+  /// Each merged block is pushed to a higher index, so it is visited later in the pass.
+  /// Locks all indices in per-index locking.
+  void coalesceInternal() noexcept;
+
+  /// Merges the block with its buddy if free, without going on with the merged one.
+  /// Removes no other block than aBlock from the list of aIndex.
+  void mergeOnce(uint8_t* const aBlock, size_t const aIndex) noexcept;
+
+  /// The best node found so far by reserveSparseNode.
+  struct SparseNode final {
+    uint8_t* mStart;
+    size_t   mIndex;
+    size_t   mUsed;
+  };
+
+  /// Visits the node of aIndex at aNode, which is a block start, and its descendants for reserveSparseNode.
+  /// @returns the used bytes of the node, and in aMovableOnly if aMovable accepts all its used blocks.
+  template<typename tMovable>
+  size_t examineNode(uint8_t* const aNode, size_t const aIndex, tMovable const& aMovable, size_t const aDivisor, SparseNode& aBest, bool& aMovableOnly) const noexcept;
+};
+
+/// Holds an object of the front ends below. Its operator new forms take the memory from tFrontEnd::allocate with the
+/// size and the placement argument if any, and its operator delete forms give it back to tFrontEnd::deallocate.
+template<typename tFrontEnd, typename tClass>
+struct FibonacciWrapper final {
 public:
-  static void init(bool const aExactAllocation) { 
-    sFibonacci = new(tMemory) FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory>(aExactAllocation);
+  tClass mPayload;
+
+  template<typename ...tParameters>
+  FibonacciWrapper(tParameters&&... aParameters) : mPayload(std::forward<tParameters>(aParameters)...) {
   }
 
-  static void init(void* aMemory, bool const aExactAllocation) { 
-    sFibonacci = new(aMemory) FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory>(aMemory, aExactAllocation);
+  void* operator new(size_t aSize) {
+    return tFrontEnd::allocate(aSize);
   }
 
-  template<typename tClass, typename ...tParameters>
-  static tClass* _new(tParameters... aParameters) {
-    Wrapper<tClass, tParameters...> *wrapper = new Wrapper<tClass, tParameters...>(aParameters...);
-    return &wrapper->mPayload;
+  void* operator new[](size_t aSize) {
+    return tFrontEnd::allocate(aSize);
   }
 
-  template<typename tClass>
-  static tClass* _newArray(size_t const aCount) {
-    Wrapper<tClass> *wrapper = new Wrapper<tClass>[aCount];
-    return &wrapper->mPayload;
+  template<typename tPlacement>
+  void* operator new(size_t aSize, tPlacement const aPlacement) {
+    return tFrontEnd::allocate(aSize, aPlacement);
   }
 
-  template<typename tClass>
-  static void _delete(tClass* aPointer) {
-    delete reinterpret_cast<Wrapper<tClass>*>(aPointer);
+  template<typename tPlacement>
+  void* operator new[](size_t aSize, tPlacement const aPlacement) {
+    return tFrontEnd::allocate(aSize, aPlacement);
+  }
+
+  void operator delete(void* aPointer) {
+    tFrontEnd::deallocate(aPointer);
+  }
+
+  void operator delete[](void* aPointer) {
+    tFrontEnd::deallocate(aPointer);
+  }
+
+  template<typename tPlacement>
+  void operator delete(void* aPointer, tPlacement const) { // called if the constructor throws
+    tFrontEnd::deallocate(aPointer);
+  }
+
+  template<typename tPlacement>
+  void operator delete[](void* aPointer, tPlacement const) {
+    tFrontEnd::deallocate(aPointer);
+  }
+};
+
+/// The object creation and deletion shared by NewDelete, ShardedNewDelete and RegionNewDelete, which derive from it.
+/// tFrontEnd must befriend FibonacciWrapper.
+template<typename tFrontEnd>
+class FibonacciObjects {
+public:
+  template<typename tClass, typename ...tParameters>
+  static tClass* _new(tParameters&&... aParameters) {
+    FibonacciWrapper<tFrontEnd, tClass> *wrapper = new FibonacciWrapper<tFrontEnd, tClass>(std::forward<tParameters>(aParameters)...);
+    return &wrapper->mPayload;
+  }
+
+  template<typename tClass>
+  static tClass* _newArray(size_t const aCount) {
+    FibonacciWrapper<tFrontEnd, tClass> *wrapper = new FibonacciWrapper<tFrontEnd, tClass>[aCount];
+    return &wrapper->mPayload;
+  }
+
+  template<typename tClass>
+  static void _delete(tClass* aPointer) {
+    delete reinterpret_cast<FibonacciWrapper<tFrontEnd, tClass>*>(aPointer);
+  }
+
+  template<typename tClass>
+  static void _deleteArray(tClass* aPointer) {
+    delete[] reinterpret_cast<FibonacciWrapper<tFrontEnd, tClass>*>(aPointer);
+  }
+
+protected:
+  /// Like _new, passing aPlacement to tFrontEnd::allocate. The object can be deleted using _delete.
+  template<typename tClass, typename tPlacement, typename ...tParameters>
+  static tClass* newPlaced(tPlacement const aPlacement, tParameters&&... aParameters) {
+    FibonacciWrapper<tFrontEnd, tClass> *wrapper = new(aPlacement) FibonacciWrapper<tFrontEnd, tClass>(std::forward<tParameters>(aParameters)...);
+    return &wrapper->mPayload;
+  }
+
+  /// Like _newArray, passing aPlacement to tFrontEnd::allocate. The array can be deleted using _deleteArray.
+  template<typename tClass, typename tPlacement>
+  static tClass* newArrayPlaced(tPlacement const aPlacement, size_t const aCount) {
+    FibonacciWrapper<tFrontEnd, tClass> *wrapper = new(aPlacement) FibonacciWrapper<tFrontEnd, tClass>[aCount];
+    return &wrapper->mPayload;
+  }
+};
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory = 0u, typename tConfig = FibonacciConfig>
+class NewDelete final : public FibonacciObjects<NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>> {
+private: 
+  typedef FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig> Manager;
+  typedef FibonacciObjects<NewDelete> Objects;
+
+  template<typename, typename> friend struct FibonacciWrapper;
+
+  static constexpr bool   cThreadCacheEnabled = tConfig::cThreadCacheDepth > 0u && tConfig::cThreadCacheIndexCount > 0u;
+  static constexpr size_t cCacheDepth         = cThreadCacheEnabled ? tConfig::cThreadCacheDepth : 1u;
+  static constexpr size_t cCacheIndexCount    = cThreadCacheEnabled ? tConfig::cThreadCacheIndexCount : 1u;
+  static constexpr size_t cCacheBatch         = (cCacheDepth + 1u) / 2u;
+  static constexpr size_t cBulkChunk          = 64u;
+  static constexpr bool   cGrowthEnabled      = tConfig::cGrowthRegionCount > 0u;
+  static constexpr size_t cGrowthSlots        = cGrowthEnabled ? tConfig::cGrowthRegionCount : 1u;
+  static constexpr bool   cHandlesEnabled     = tConfig::cHandleCount > 0u;
+  static constexpr size_t cHandleSlots        = cHandlesEnabled ? tConfig::cHandleCount : 1u;
+  static constexpr size_t cEvacuateDivisor    = 2u; // compact evacuates a node of the buddy tree only if at most 1 / this of it is used
+
+  static_assert(!tConfig::cPositionIndependent || !cGrowthEnabled, "The additional regions would not survive attaching a position independent heap.");
+  static_assert(!tConfig::cPositionIndependent || !cHandlesEnabled, "The handle table would not survive attaching a position independent heap.");
+  static_assert(!tConfig::cStatistics || tConfig::cThreadCacheDepth == 0u, "The statistics would count the refills of the thread caches instead of the requests.");
+
+  /// Blocks of the small indices kept by a thread. These are allocated as far as the manager knows.
+  class ThreadCache final {
+  public:
+    size_t mGeneration = 0u;
+    size_t mCounts[cCacheIndexCount] = {};
+    void*  mBlocks[cCacheIndexCount][cCacheDepth];
+
+    ~ThreadCache() { // drops the blocks instead if the heap was initialized again or torn down meanwhile
+      flushThreadCache(*this);
+    }
+  };
+
+  static Manager*                 sFibonacci; // could be inline for c++17
+  static std::atomic<size_t>      sGeneration; // incremented by init and teardown to let the thread caches drop blocks of a previous heap
+  static thread_local ThreadCache sThreadCache;
+
+  static bool                          sExactAllocation;
+  static std::atomic<uint8_t*>         sRegions[cGrowthSlots];  // got from tInterface::grow, each starting with its manager, nullptr if unused
+  static std::atomic<size_t>           sRegionDeallocations;    // in progress, releaseEmptyRegions waits for them
+  static typename tConfig::InstanceLock sGrowthLock;            // serializes allocating from and releasing the additional regions
+
+  /// Entry of the handle table, the handle is its index + 1.
+  struct HandleEntry final {
+    uint8_t* mPointer;  // nullptr if unused
+    size_t   mSize;     // requested, copied when moving
+    size_t   mPins;
+    size_t   mNextFree; // index of the next unused entry, cHandleSlots at the end
+  };
+
+  static HandleEntry                    sHandles[cHandleSlots];
+  static size_t                         sFreeHandle;   // first unused entry
+  static size_t                         sHandleCursor; // where compact continues
+  static size_t                         sPassRemaining; // handles compact examines before the pass ends, 0 if there is no pass
+  static size_t                         sEvacuees;      // blocks of handles in the node not examined yet by the pass
+  static uint8_t*                       sEvacuateStart; // of the node evacuated by the pass, nullptr if none
+  static uint8_t*                       sEvacuateEnd;
+  static void*                          sPassBlocks[cHandleSlots]; // sorted payloads of the handles not pinned while choosing the node,
+  static size_t                         sPassBlockCount;           // then the blocks of the node kept allocated until the pass ends
+  static size_t                         sMoving;       // entry whose block compact copies, cHandleSlots if none
+  static bool                           sMovingPinned; // pinned during the copy, so compact keeps the block
+  static bool                           sMovingFreed;  // freed during the copy, so compact frees the block
+  static typename tConfig::InstanceLock sHandleLock;   // serializes the handle table
+  static typename tConfig::InstanceLock sCompactLock;  // serializes the calls of compact
+
+  /// Passed to the placement forms of operator new of FibonacciWrapper.
+  struct Alignment final {
+    size_t mValue;
+  };
+
+  template<typename tClass>
+  using Wrapper = FibonacciWrapper<NewDelete, tClass>;
+
+public:
+  /// Identifies a block which compact() may move. 0 is never a valid handle.
+  typedef size_t Handle;
+
+  /// Forgets the additional regions and the handles of a previous heap without releasing them.
+  static void init(bool const aExactAllocation) { 
+    sFibonacci = new(reinterpret_cast<void*>(tMemory)) Manager(aExactAllocation);
+    sGeneration.fetch_add(1u, std::memory_order_acq_rel);
+    initGrowth(aExactAllocation);
+    initHandles();
+  }
+
+  static void init(void* aMemory, bool const aExactAllocation) { 
+    sFibonacci = new(aMemory) Manager(aMemory, aExactAllocation);
+    sGeneration.fetch_add(1u, std::memory_order_acq_rel);
+    initGrowth(aExactAllocation);
+    initHandles();
+  }
+
+  /// Resumes the heap at aMemory built by init with cPositionIndependent, see FibonacciMemoryManager::attach.
+  static void attach(void* aMemory) {
+    sFibonacci = Manager::attach(aMemory);
+    sGeneration.fetch_add(1u, std::memory_order_acq_rel);
+  }
+
+  /// Forgets the heap before its memory is given back, so the thread caches of the threads exiting later drop
+  /// their blocks instead of writing them back into it. Nothing may be allocated or freed until the next init.
+  static void teardown() noexcept {
+    sGeneration.fetch_add(1u, std::memory_order_acq_rel);
+    sFibonacci = nullptr;
+  }
+
+  /// Returns the blocks kept by the calling thread to the manager. Happens automatically on thread exit.
+  static void flushThreadCache() {
+    flushThreadCache(std::integral_constant<bool, cThreadCacheEnabled>());
+  }
+
+  using Objects::_new;
+  using Objects::_newArray;
+  using Objects::_delete;
+  using Objects::_deleteArray;
+
+  /// Like _new, but aligns the object to tAlign, which may exceed the alignment of the manager.
+  /// The object can be deleted using _delete.
+  template<typename tClass, size_t tAlign, typename ...tParameters>
+  static tClass* _newAligned(tParameters&&... aParameters) {
+    return Objects::template newPlaced<tClass>(Alignment{tAlign}, std::forward<tParameters>(aParameters)...);
+  }
+
+  /// Like _newArray, but aligns the array start to tAlign. The array can be deleted using _deleteArray.
+  template<typename tClass, size_t tAlign>
+  static tClass* _newArrayAligned(size_t const aCount) {
+    return Objects::template newArrayPlaced<tClass>(Alignment{tAlign}, aCount);
+  }
+
+  /// Deletes using _delete. Stateless and not final, so a UniquePointer is as large as a raw pointer.
+  template<typename tClass>
+  struct Deleter {
+    void operator()(tClass* const aPointer) const {
+      _delete(aPointer);
+    }
+  };
+
+  template<typename tClass>
+  using UniquePointer = std::unique_ptr<tClass, Deleter<tClass>>;
+
+  /// Like _new, but owned by the result. The object is not copied, the parameters are forwarded to its constructor.
+  template<typename tClass, typename ...tParameters>
+  static UniquePointer<tClass> _makeUnique(tParameters&&... aParameters) {
+    return UniquePointer<tClass>(Objects::template _new<tClass>(std::forward<tParameters>(aParameters)...));
+  }
+
+  /// Stateless standard allocator over this heap for containers and std::allocate_shared.
+  /// Needs a throwing badAlloc, because the standard containers do not check for nullptr.
+  /// Not final, so the standard library can store it as an empty base.
+  template<typename tClass>
+  class Allocator {
+  public:
+    typedef tClass value_type;
+
+    Allocator() noexcept = default;
+
+    template<typename tOther>
+    Allocator(Allocator<tOther> const&) noexcept {
+    }
+
+    tClass* allocate(size_t const aCount) {
+      void* result = nullptr;
+      if(aCount > std::numeric_limits<size_t>::max() / sizeof(tClass)) {
+        tInterface::badAlloc();
+      }
+      else if(alignof(tClass) > tAlignment) {
+        result = _allocateAligned(aCount * sizeof(tClass), alignof(tClass));
+      }
+      else {
+        result = _allocate(aCount * sizeof(tClass));
+      }
+      return static_cast<tClass*>(result);
+    }
+
+    void deallocate(tClass* const aPointer, size_t const) noexcept {
+      _deallocate(aPointer);
+    }
+
+    template<typename tOther>
+    bool operator==(Allocator<tOther> const&) const noexcept {
+      return true;
+    }
+
+    template<typename tOther>
+    bool operator!=(Allocator<tOther> const&) const noexcept {
+      return false;
+    }
+  };
+
+  /// Like std::make_shared, the object and the control block share one block of this heap.
+  /// Needs a throwing badAlloc.
+  template<typename tClass, typename ...tParameters>
+  static std::shared_ptr<tClass> _allocateShared(tParameters&&... aParameters) {
+    return std::allocate_shared<tClass>(Allocator<tClass>(), std::forward<tParameters>(aParameters)...);
+  }
+
+  /// Raw memory for a malloc-like C API, see FibonacciMalloc.h. These call badAlloc on failure, and return nullptr if it returns.
+  static void* _allocate(size_t const aSize) {
+    return allocate(aSize);
+  }
+
+  /// aAlignment must be a power of 2 and may exceed the alignment of the manager.
+  static void* _allocateAligned(size_t const aSize, size_t const aAlignment) {
+    return allocateBlock(aSize, aAlignment);
+  }
+
+  static void _deallocate(void* const aPointer) {
+    deallocate(aPointer);
+  }
+
+  /// Like realloc, but 0 aSize frees the block and returns nullptr. The region holding the block resizes it in place if it can,
+  /// or moves it within itself. With growth, only if that fails it allocates, copies and frees, so an other region may serve it.
+  static void* _reallocate(void* const aPointer, size_t const aSize);
+
+  /// @returns the bytes usable from aPointer, or 0 if it was not allocated here.
+  static size_t getUsableSize(void const * const aPointer) noexcept {
+    Manager const* owner = findOwner(aPointer);
+    return owner != nullptr ? owner->getUsableSize(aPointer) : 0u;
+  }
+
+  /// Allocates a movable block of aSize bytes if FibonacciConfig::cHandleCount > 0. Its address is valid only while pinned.
+  /// Calls badAlloc if there is no memory or no unused handle.
+  /// @returns the handle, or 0 if badAlloc returns.
+  static Handle _allocateHandle(size_t const aSize);
+
+  /// Calls badAlloc for 0, unknown, already freed or pinned handles, like the manager does for an invalid pointer.
+  static void _deallocateHandle(Handle const aHandle);
+
+  /// Keeps the block of aHandle in place until the matching unpin. The pins of a handle nest.
+  /// @returns the current address of the block, or nullptr for an invalid handle.
+  static void* pin(Handle const aHandle) noexcept;
+
+  /// Ignores invalid handles and the ones not pinned.
+  static void unpin(Handle const aHandle) noexcept;
+
+  /// Examines at most aBudget handles, continuing where the previous call stopped. Works in passes of at most cHandleCount
+  /// handles. Each pass evacuates a node of the buddy tree having only blocks of handles not pinned, the largest one
+  /// at most half used and larger than any free block, see Manager::reserveSparseNode. Only the blocks inside that node or in the additional regions move,
+  /// to blocks of the heap given to init outside the node, so each block moves at most once per pass. Slab slots stay.
+  /// The free blocks of the node stay allocated until the pass ends, so nothing else is placed there meanwhile.
+  /// The handle table is locked only to pick a handle and to swap its address, not during the allocation and the copy.
+  /// A handle pinned meanwhile keeps its old block, and a freed one loses both.
+  /// @returns the number of blocks moved.
+  static size_t compact(size_t const aBudget);
+
+  /// Ends the pass of compact early, freeing the blocks it keeps allocated in the node. The next call starts a new pass.
+  static void stopCompaction() {
+    sCompactLock.lock();
+    endPass();
+    sCompactLock.unlock();
+  }
+
+  /// Creates at most aCount objects using their default constructor, with one lock per cBulkChunk objects.
+  /// Continues in the additional regions once the heap given to init runs short.
+  /// The objects may be deleted one by one using _delete as well.
+  /// @returns the number of objects created, does not call badAlloc.
+  template<typename tClass>
+  static size_t _newBulk(size_t const aCount, tClass** const aPointers);
+
+  /// Deletes the non-null objects created by _new or _newBulk, with one lock per cBulkChunk objects.
+  /// The ones in the additional regions are freed one by one.
+  template<typename tClass>
+  static void _deleteBulk(tClass* const * const aPointers, size_t const aCount);
+  
+  /// Includes the additional regions.
+  static size_t getFreeSpace() noexcept {
+    size_t result = sFibonacci->getFreeSpace();
+    forEachRegion([&result](Manager* const aManager) {
+      result += aManager->getFreeSpace();
+    });
+    return result;
+  }
+
+  static size_t getMaxUserBlockSize() noexcept {
+    return sFibonacci->getMaxUserBlockSize();
+  }
+
+  /// Includes the additional regions.
+  static size_t getMaxFreeUserBlockSize() noexcept {
+    size_t result = sFibonacci->getMaxFreeUserBlockSize();
+    forEachRegion([&result](Manager* const aManager) {
+      result = std::max(result, aManager->getMaxFreeUserBlockSize());
+    });
+    return result;
+  }
+
+  static size_t getAlignment() noexcept {
+    return sFibonacci->getAlignment();
+  }
+  
+  /// Merges the free buddies left apart by lazy coalescing.
+  static void coalesce() noexcept {
+    sFibonacci->coalesce();
+    forEachRegion([](Manager* const aManager) {
+      aManager->coalesce();
+    });
+  }
+
+  /// Flushes the thread cache of the caller, ends the pass of compact and coalesces first, but can't flush for other threads.
+  /// Checks the additional regions too.
+  static bool isCorrectEmpty() noexcept {
+    flushThreadCache();
+    stopCompaction();
+    coalesce();
+    bool result = sFibonacci->isCorrectEmpty();
+    forEachRegion([&result](Manager* const aManager) {
+      result = aManager->isCorrectEmpty() && result;
+    });
+    return result;
+  }
+
+  /// Gives the additional regions without allocated blocks back to tInterface::release if FibonacciConfig::cGrowthRegionCount > 0.
+  /// @returns the number of regions released.
+  static size_t releaseEmptyRegions() {
+    return releaseEmptyRegions(std::integral_constant<bool, cGrowthEnabled>());
+  }
+
+  /// @returns the number of additional regions in use.
+  static size_t getRegionCount() noexcept {
+    size_t result = 0u;
+    forEachRegion([&result](Manager* const) {
+      ++result;
+    });
+    return result;
+  }
+
+  /// Blocks in the thread caches count as allocated. Sums the additional regions in use, so the peak is an upper bound.
+  static typename Manager::Statistics getStatistics() noexcept {
+    typename Manager::Statistics result = sFibonacci->getStatistics();
+    forEachRegion([&result](Manager* const aManager) {
+      result.add(aManager->getStatistics());
+    });
+    return result;
+  }
+
+  /// Not thread safe, blocks in the thread caches appear as used. Excludes the additional regions.
+  static typename Manager::Blocks getBlocks() noexcept {
+    return sFibonacci->getBlocks();
+  }
+
+  static size_t dump(void* const aBuffer, size_t const aSize) noexcept {
+    return sFibonacci->dump(aBuffer, aSize);
+  }
+
+private:
+  static void* allocate(size_t const aSize) {
+    return allocate(aSize, std::integral_constant<bool, cThreadCacheEnabled>());
+  }
+
+  static void deallocate(void* const aPointer) {
+    deallocate(aPointer, std::integral_constant<bool, cThreadCacheEnabled>());
+  }
+
+  static void* allocate(size_t const aSize, Alignment const aAlignment) {
+    return allocateBlock(aSize, aAlignment.mValue);
+  }
+
+  static void* allocate(size_t const aSize, std::false_type) {
+    return allocateBlock(aSize, tAlignment);
+  }
+
+  static void deallocate(void* const aPointer, std::false_type) {
+    deallocateBlock(aPointer);
+  }
+
+  /// Allocates from the heap given to init, or from the additional regions if that is full.
+  static void* allocateBlock(size_t const aSize, size_t const aAlignment) {
+    return allocateBlock(aSize, aAlignment, std::integral_constant<bool, cGrowthEnabled>());
+  }
+
+  static void deallocateBlock(void* const aPointer) {
+    deallocateBlock(aPointer, std::integral_constant<bool, cGrowthEnabled>());
+  }
+
+  /// @returns the manager of the heap given to init or of the additional region containing aPointer, or nullptr if none.
+  static Manager* findOwner(void const * const aPointer) noexcept {
+    Manager* result = (sFibonacci->contains(aPointer) ? sFibonacci : nullptr);
+    forEachRegion([aPointer, &result](Manager* const aManager) {
+      if(aManager->contains(aPointer)) {
+        result = aManager;
+      }
+      else { // nothing to do
+      }
+    });
+    return result;
+  }
+
+  static void* allocateBlock(size_t const aSize, size_t const aAlignment, std::false_type) {
+    return sFibonacci->allocateAligned(aSize, aAlignment);
+  }
+
+  static void deallocateBlock(void* const aPointer, std::false_type) {
+    sFibonacci->deallocate(aPointer);
+  }
+
+  static void* allocateBlock(size_t const aSize, size_t const aAlignment, std::true_type);
+  static void deallocateBlock(void* const aPointer, std::true_type);
+
+  /// Like Manager::allocateBulk, continuing in the additional regions once the heap given to init runs short.
+  static size_t allocateBulk(size_t const aSize, size_t const aCount, void** const aPointers) {
+    return allocateBulk(aSize, aCount, aPointers, std::integral_constant<bool, cGrowthEnabled>());
+  }
+
+  /// Like Manager::deallocateBulk, but the blocks may belong to any region.
+  static void deallocateBulk(void* const * const aPointers, size_t const aCount) {
+    deallocateBulk(aPointers, aCount, std::integral_constant<bool, cGrowthEnabled>());
+  }
+
+  static size_t allocateBulk(size_t const aSize, size_t const aCount, void** const aPointers, std::false_type) {
+    return sFibonacci->allocateBulk(aSize, aCount, aPointers);
+  }
+
+  static void deallocateBulk(void* const * const aPointers, size_t const aCount, std::false_type) {
+    sFibonacci->deallocateBulk(aPointers, aCount);
+  }
+
+  static size_t allocateBulk(size_t const aSize, size_t const aCount, void** const aPointers, std::true_type);
+  static void deallocateBulk(void* const * const aPointers, size_t const aCount, std::true_type);
+
+  /// Must be called holding sGrowthLock.
+  /// @returns the manager of the additional region aIndex, creating it if unused, or nullptr if tInterface::grow failed.
+  static Manager* getRegion(size_t const aIndex);
+
+  static size_t releaseEmptyRegions(std::false_type) noexcept {
+    return 0u;
+  }
+
+  static size_t releaseEmptyRegions(std::true_type);
+
+  static void initHandles() noexcept {
+    for(size_t i = 0u; i < cHandleSlots; ++i) {
+      sHandles[i].mPointer = nullptr;
+      sHandles[i].mNextFree = i + 1u;
+    }
+    sFreeHandle = (cHandlesEnabled ? 0u : cHandleSlots);
+    sHandleCursor = 0u;
+    sPassRemaining = 0u;
+    sEvacuees = 0u;
+    sEvacuateStart = nullptr;
+    sEvacuateEnd = nullptr;
+    sPassBlockCount = 0u;
+    sMoving = cHandleSlots;
+  }
+
+  /// Must be called holding sCompactLock. Chooses the node of the heap given to init, whose blocks compact moves out of
+  /// until it has examined all of them or cHandleSlots handles, see Manager::reserveSparseNode.
+  static void startPass();
+
+  /// Must be called holding sCompactLock. Frees the blocks kept allocated in the node.
+  static void endPass() {
+    deallocateBulk(sPassBlocks, sPassBlockCount);
+    sPassBlockCount = 0u;
+    sPassRemaining = 0u;
+    sEvacuees = 0u;
+    sEvacuateStart = nullptr;
+    sEvacuateEnd = nullptr;
+  }
+
+  /// Must be called holding sCompactLock.
+  /// @returns true if aPointer is in the node evacuated by the pass or in an additional region.
+  static bool isEvacuated(uint8_t const * const aPointer) noexcept {
+    return (aPointer >= sEvacuateStart && aPointer < sEvacuateEnd) || !sFibonacci->contains(aPointer);
+  }
+
+  /// Must be called holding sHandleLock.
+  static bool isValid(Handle const aHandle) noexcept {
+    return aHandle > 0u && aHandle <= cHandleSlots && sHandles[aHandle - 1u].mPointer != nullptr;
+  }
+
+  static void initGrowth(bool const aExactAllocation) noexcept {
+    sExactAllocation = aExactAllocation;
+    for(auto& region : sRegions) {
+      region.store(nullptr, std::memory_order_relaxed);
+    }
+  }
+
+  /// Calls aFunction with the manager of each additional region while no region can be released.
+  template<typename tFunction>
+  static void forEachRegion(tFunction aFunction) noexcept {
+    if(cGrowthEnabled) {
+      sGrowthLock.lock();
+      for(auto& region : sRegions) {
+        uint8_t* memory = region.load(std::memory_order_relaxed);
+        if(memory != nullptr) {
+          aFunction(reinterpret_cast<Manager*>(memory));
+        }
+        else { // nothing to do
+        }
+      }
+      sGrowthLock.unlock();
+    }
+    else { // nothing to do
+    }
+  }
+
+  static void flushThreadCache(std::false_type) noexcept { // nothing to do
+  }
+
+  static void* allocate(size_t const aSize, std::true_type);
+  static void deallocate(void* const aPointer, std::true_type);
+
+  static void flushThreadCache(std::true_type) {
+    flushThreadCache(sThreadCache);
+  }
+
+  static void flushThreadCache(ThreadCache& aCache);
+  static ThreadCache& getThreadCache() noexcept;
+
+  /// Gives back blocks of a thread cache to the manager.
+  static void uncache(void* const * const aBlocks, size_t const aCount) {
+    for(size_t i = 0u; i < aCount; ++i) {
+      sFibonacci->setCached(aBlocks[i], false);
+    }
+    sFibonacci->deallocateBulk(aBlocks, aCount);
+  }
+};
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+typename NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::Manager* NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::sFibonacci;
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+std::atomic<size_t> NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::sGeneration;
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+thread_local typename NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::ThreadCache NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::sThreadCache;
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+bool NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::sExactAllocation;
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+std::atomic<uint8_t*> NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::sRegions[NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::cGrowthSlots];
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+std::atomic<size_t> NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::sRegionDeallocations;
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+typename tConfig::InstanceLock NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::sGrowthLock;
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+typename NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::HandleEntry NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::sHandles[NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::cHandleSlots];
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+size_t NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::sFreeHandle;
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+size_t NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::sHandleCursor;
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+size_t NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::sPassRemaining;
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+size_t NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::sEvacuees;
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+uint8_t* NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::sEvacuateStart;
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+uint8_t* NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::sEvacuateEnd;
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void* NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::sPassBlocks[NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::cHandleSlots];
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+size_t NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::sPassBlockCount;
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+size_t NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::sMoving;
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+bool NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::sMovingPinned;
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+bool NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::sMovingFreed;
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+typename tConfig::InstanceLock NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::sHandleLock;
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+typename tConfig::InstanceLock NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::sCompactLock;
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+typename NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::Handle NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::_allocateHandle(size_t const aSize) {
+  Handle result = 0u;
+  uint8_t* block = static_cast<uint8_t*>(allocate(aSize));
+  if(block != nullptr) {
+    sHandleLock.lock();
+    if(sFreeHandle < cHandleSlots) {
+      HandleEntry& entry = sHandles[sFreeHandle];
+      result = sFreeHandle + 1u;
+      sFreeHandle = entry.mNextFree;
+      entry.mPointer = block;
+      entry.mSize = aSize;
+      entry.mPins = 0u;
+    }
+    else { // nothing to do
+    }
+    sHandleLock.unlock();
+    if(result == 0u) {
+      deallocate(block);
+      tInterface::badAlloc();
+    }
+    else { // nothing to do
+    }
+  }
+  else { // nothing to do
+  }
+  return result;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::_deallocateHandle(Handle const aHandle) {
+  uint8_t* block = nullptr;
+  sHandleLock.lock();
+  bool valid = isValid(aHandle) && sHandles[aHandle - 1u].mPins == 0u;
+  if(valid) {
+    HandleEntry& entry = sHandles[aHandle - 1u];
+    block = entry.mPointer;
+    entry.mPointer = nullptr;
+    entry.mNextFree = sFreeHandle;
+    sFreeHandle = aHandle - 1u;
+  }
+  else { // nothing to do
+  }
+  if(valid && sMoving == aHandle - 1u) { // compact frees the block after the copy
+    sMoving = cHandleSlots;
+    sMovingFreed = true;
+    block = nullptr;
+  }
+  else { // nothing to do
+  }
+  sHandleLock.unlock();
+  if(!valid) {
+    tInterface::badAlloc();
+  }
+  else if(block != nullptr) {
+    deallocate(block);
+  }
+  else { // nothing to do
+  }
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void* NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::pin(Handle const aHandle) noexcept {
+  void* result = nullptr;
+  sHandleLock.lock();
+  if(isValid(aHandle)) {
+    HandleEntry& entry = sHandles[aHandle - 1u];
+    ++entry.mPins;
+    result = entry.mPointer;
+    sMovingPinned = sMovingPinned || sMoving == aHandle - 1u;
+  }
+  else { // nothing to do
+  }
+  sHandleLock.unlock();
+  return result;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::unpin(Handle const aHandle) noexcept {
+  sHandleLock.lock();
+  if(isValid(aHandle) && sHandles[aHandle - 1u].mPins > 0u) {
+    --sHandles[aHandle - 1u].mPins;
+  }
+  else { // nothing to do
+  }
+  sHandleLock.unlock();
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+size_t NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::compact(size_t const aBudget) {
+  size_t moved = 0u;
+  void* held[cBulkChunk]; // blocks to free once there is no room in sPassBlocks, kept a while so the LIFO free lists do not offer them again
+  size_t heldCount = 0u;
+  sCompactLock.lock();
+  for(size_t i = 0u; cHandlesEnabled && i < aBudget; ++i) {
+    if(sPassRemaining == 0u) {
+      startPass();
+    }
+    else { // nothing to do
+    }
+    if(heldCount + 3u > cBulkChunk) { // an iteration holds at most 2 blocks after the rejected ones
+      deallocateBulk(held, heldCount);
+      heldCount = 0u;
+    }
+    else { // nothing to do
+    }
+    uint8_t* source = nullptr;
+    size_t size = 0u;
+    sHandleLock.lock();
+    HandleEntry& entry = sHandles[sHandleCursor];
+    bool inNode = entry.mPointer >= sEvacuateStart && entry.mPointer < sEvacuateEnd;
+    if(entry.mPointer != nullptr && entry.mPins == 0u && entry.mSize > Manager::getMaxSlotSize() && isEvacuated(entry.mPointer)) {
+      source = entry.mPointer;
+      size = entry.mSize;
+      sMoving = sHandleCursor;
+      sMovingPinned = false;
+      sMovingFreed = false;
+    }
+    else { // nothing to do
+    }
+    sHandleCursor = (sHandleCursor + 1u) % cHandleSlots;
+    --sPassRemaining;
+    sEvacuees -= (inNode && sEvacuees > 0u ? 1u : 0u);
+    sHandleLock.unlock();
+    uint8_t* target = (source != nullptr ? static_cast<uint8_t*>(sFibonacci->tryAllocate(size)) : nullptr);
+    while(target != nullptr && isEvacuated(target) && heldCount + 2u < cBulkChunk) { // freed in the node meanwhile, the next try gets an other block
+      held[heldCount] = target;
+      ++heldCount;
+      target = static_cast<uint8_t*>(sFibonacci->tryAllocate(size));
+    }
+    if(target != nullptr && isEvacuated(target)) { // no room to hold it
+      sFibonacci->deallocate(target);
+      target = nullptr;
+    }
+    else { // nothing to do
+    }
+    if(target != nullptr) {
+      std::memcpy(target, source, size); // the block stays allocated until sMoving is cleared
+    }
+    else { // nothing to do
+    }
+    uint8_t* unused = nullptr; // of source and target
+    sHandleLock.lock();
+    if(target != nullptr && !sMovingFreed && !sMovingPinned) {
+      entry.mPointer = target;
+      unused = source;
+      ++moved;
+    }
+    else if(target != nullptr) {
+      unused = target;
+    }
+    else { // nothing to do
+    }
+    uint8_t* freed = (source != nullptr && sMovingFreed ? source : nullptr); // by _deallocateHandle meanwhile
+    sMoving = cHandleSlots;
+    sMovingFreed = false;
+    sHandleLock.unlock();
+    for(uint8_t* block : { unused, freed }) {
+      if(block == nullptr) { // nothing to do
+      }
+      else if(inNode && sPassBlockCount < cHandleSlots) { // stays allocated until the pass ends
+        sPassBlocks[sPassBlockCount] = block;
+        ++sPassBlockCount;
+      }
+      else {
+        held[heldCount] = block;
+        ++heldCount;
+      }
+    }
+    if(sPassRemaining == 0u || (sEvacuateStart != nullptr && sEvacuees == 0u)) {
+      endPass();
+    }
+    else { // nothing to do
+    }
+  }
+  deallocateBulk(held, heldCount);
+  sCompactLock.unlock();
+  return moved;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::startPass() {
+  size_t count = 0u;
+  sHandleLock.lock();
+  for(auto const& entry : sHandles) {
+    if(entry.mPointer != nullptr && entry.mPins == 0u && entry.mSize > Manager::getMaxSlotSize()) {
+      sPassBlocks[count] = entry.mPointer;
+      ++count;
+    }
+    else { // nothing to do
+    }
+  }
+  sHandleLock.unlock();
+  std::sort(sPassBlocks, sPassBlocks + count, std::less<void*>());
+  void* start;
+  void* end;
+  sPassBlockCount = sFibonacci->reserveSparseNode([count](uint8_t* const aPayload) {
+    return std::binary_search(sPassBlocks, sPassBlocks + count, static_cast<void*>(aPayload), std::less<void*>());
+  }, cEvacuateDivisor, sPassBlocks, cHandleSlots, start, end);
+  sEvacuateStart = static_cast<uint8_t*>(start);
+  sEvacuateEnd = static_cast<uint8_t*>(end);
+  sEvacuees = 0u;
+  sHandleLock.lock();
+  for(auto const& entry : sHandles) {
+    sEvacuees += (entry.mPointer >= sEvacuateStart && entry.mPointer < sEvacuateEnd ? 1u : 0u);
+  }
+  sHandleLock.unlock();
+  sPassRemaining = cHandleSlots;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+template<typename tClass>
+size_t NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::_newBulk(size_t const aCount, tClass** const aPointers) {
+  void* blocks[cBulkChunk];
+  size_t count = 0u;
+  while(count < aCount) {
+    size_t wanted = (aCount - count < cBulkChunk ? aCount - count : cBulkChunk);
+    size_t got = allocateBulk(sizeof(Wrapper<tClass>), wanted, blocks);
+    for(size_t i = 0u; i < got; ++i) {
+      aPointers[count] = &(::new(blocks[i]) Wrapper<tClass>())->mPayload;
+      ++count;
+    }
+    if(got < wanted) {
+      break;
+    }
+    else { // nothing to do
+    }
+  }
+  return count;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+template<typename tClass>
+void NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::_deleteBulk(tClass* const * const aPointers, size_t const aCount) {
+  void* blocks[cBulkChunk];
+  for(size_t done = 0u; done < aCount; done += cBulkChunk) {
+    size_t chunk = (aCount - done < cBulkChunk ? aCount - done : cBulkChunk);
+    for(size_t i = 0u; i < chunk; ++i) {
+      Wrapper<tClass>* wrapper = reinterpret_cast<Wrapper<tClass>*>(aPointers[done + i]);
+      if(wrapper != nullptr) {
+        wrapper->~Wrapper<tClass>();
+      }
+      else { // nothing to do
+      }
+      blocks[i] = wrapper;
+    }
+    deallocateBulk(blocks, chunk);
+  }
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void* NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::_reallocate(void* const aPointer, size_t const aSize) {
+  void* result = nullptr;
+  if(aPointer == nullptr) {
+    result = allocate(aSize);
+  }
+  else if(aSize == 0u) {
+    deallocate(aPointer);
+  }
+  else if(!cGrowthEnabled) {
+    result = sFibonacci->reallocate(aPointer, aSize);
+  }
+  else {
+    Manager* owner = findOwner(aPointer);
+    size_t usableSize = (owner != nullptr ? owner->getUsableSize(aPointer) : 0u);
+    result = (usableSize > 0u ? owner->tryReallocate(aPointer, aSize) : nullptr);
+    if(result != nullptr) { // nothing to do
+    }
+    else if(usableSize > 0u) { // its region is full
+      result = allocate(aSize);
+      if(result != nullptr) {
+        std::memcpy(result, aPointer, std::min(usableSize, aSize));
+        deallocate(aPointer);
+      }
+      else { // nothing to do
+      }
+    }
+    else {
+      tInterface::badAlloc();
+    }
+  }
+  return result;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void* NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::allocateBlock(size_t const aSize, size_t const aAlignment, std::true_type) {
+  void* result = sFibonacci->tryAllocateAligned(aSize, aAlignment);
+  if(result == nullptr && sFibonacci->getSuitableIndex(aSize) < sFibonacci->getFibonacciCount()) { // a new region could serve it
+    bool exhausted = false;
+    sGrowthLock.lock();
+    for(size_t i = 0u; i < cGrowthSlots && result == nullptr && !exhausted; ++i) {
+      Manager* region = getRegion(i);
+      exhausted = (region == nullptr);
+      result = (exhausted ? nullptr : region->tryAllocateAligned(aSize, aAlignment));
+    }
+    sGrowthLock.unlock();
+  }
+  else { // nothing to do
+  }
+  if(result == nullptr) {
+    tInterface::badAlloc();
+  }
+  else { // nothing to do
+  }
+  return result;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::deallocateBlock(void* const aPointer, std::true_type) {
+  uint8_t* pointer = static_cast<uint8_t*>(aPointer);
+  if(aPointer == nullptr || sFibonacci->contains(aPointer)) {
+    sFibonacci->deallocate(aPointer);
+  }
+  else {
+    sRegionDeallocations.fetch_add(1u, std::memory_order_seq_cst); // ordered before the load, see releaseEmptyRegions
+    Manager* owner = sFibonacci;
+    for(auto& region : sRegions) {
+      uint8_t* memory = region.load(std::memory_order_seq_cst);
+      if(memory != nullptr && pointer >= memory && pointer < memory + tMemorySize) {
+        owner = reinterpret_cast<Manager*>(memory);
+      }
+      else { // nothing to do
+      }
+    }
+    owner->deallocate(aPointer); // sFibonacci handles invalid pointers
+    sRegionDeallocations.fetch_sub(1u, std::memory_order_seq_cst);
+  }
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+size_t NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::allocateBulk(size_t const aSize, size_t const aCount, void** const aPointers, std::true_type) {
+  size_t result = sFibonacci->allocateBulk(aSize, aCount, aPointers);
+  if(result < aCount && sFibonacci->getSuitableIndex(aSize) < sFibonacci->getFibonacciCount()) {
+    bool exhausted = false;
+    sGrowthLock.lock();
+    for(size_t i = 0u; i < cGrowthSlots && result < aCount && !exhausted; ++i) {
+      Manager* region = getRegion(i);
+      exhausted = (region == nullptr);
+      result += (exhausted ? 0u : region->allocateBulk(aSize, aCount - result, aPointers + result));
+    }
+    sGrowthLock.unlock();
+  }
+  else { // nothing to do
+  }
+  return result;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::deallocateBulk(void* const * const aPointers, size_t const aCount, std::true_type) {
+  void* own[cBulkChunk]; // of the heap given to init, freed together
+  size_t ownCount = 0u;
+  for(size_t i = 0u; i < aCount; ++i) {
+    if(aPointers[i] == nullptr) { // nothing to do
+    }
+    else if(sFibonacci->contains(aPointers[i])) {
+      own[ownCount] = aPointers[i];
+      ++ownCount;
+      if(ownCount == cBulkChunk) {
+        sFibonacci->deallocateBulk(own, ownCount);
+        ownCount = 0u;
+      }
+      else { // nothing to do
+      }
+    }
+    else {
+      deallocateBlock(aPointers[i]); // finds the region, or reports the invalid pointer
+    }
+  }
+  sFibonacci->deallocateBulk(own, ownCount);
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+typename NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::Manager* NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::getRegion(size_t const aIndex) {
+  uint8_t* memory = sRegions[aIndex].load(std::memory_order_relaxed);
+  if(memory == nullptr) {
+    memory = static_cast<uint8_t*>(tInterface::grow(tMemorySize));
+    if(memory != nullptr) {
+      new(memory) Manager(memory, sExactAllocation);
+      sRegions[aIndex].store(memory, std::memory_order_release);
+    }
+    else { // nothing to do
+    }
+  }
+  else { // nothing to do
+  }
+  return reinterpret_cast<Manager*>(memory);
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+size_t NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::releaseEmptyRegions(std::true_type) {
+  size_t result = 0u;
+  sGrowthLock.lock();
+  for(auto& region : sRegions) {
+    uint8_t* memory = region.load(std::memory_order_relaxed);
+    Manager* manager = reinterpret_cast<Manager*>(memory);
+    if(memory != nullptr) {
+      manager->coalesce();
+    }
+    else { // nothing to do
+    }
+    if(memory != nullptr && manager->callIfEmpty([&region]() {
+      region.store(nullptr, std::memory_order_seq_cst); // a deallocation either sees this or is seen counted below
+    })) {
+      while(sRegionDeallocations.load(std::memory_order_seq_cst) > 0u) { // the one freeing its last block may still be inside the manager
+        std::this_thread::yield();
+      }
+      tInterface::release(memory, tMemorySize);
+      ++result;
+    }
+    else { // nothing to do
+    }
+  }
+  sGrowthLock.unlock();
+  return result;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void* NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::allocate(size_t const aSize, std::true_type) {
+  size_t index = sFibonacci->getSuitableIndex(aSize);
+  void* result = nullptr;
+  if(index < cCacheIndexCount && index < sFibonacci->getFibonacciCount() && aSize > Manager::getMaxSlotSize()) { // slots are not cached
+    ThreadCache& cache = getThreadCache();
+    size_t& count = cache.mCounts[index];
+    if(count == 0u) {
+      count = sFibonacci->allocateBulk(sFibonacci->getUserBlockSize(index), cCacheBatch, cache.mBlocks[index]);
+      for(size_t i = 0u; i < count; ++i) {
+        sFibonacci->setCached(cache.mBlocks[index][i], true);
+      }
+    }
+    else { // nothing to do
+    }
+    if(count > 0u) {
+      result = cache.mBlocks[index][--count];
+      sFibonacci->setCached(result, false);
+    }
+    else { // nothing to do
+    }
+  }
+  else { // nothing to do
+  }
+  if(result == nullptr) {
+    result = allocateBlock(aSize, tAlignment);
+  }
+  else { // nothing to do
+  }
+  return result;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::deallocate(void* const aPointer, std::true_type) {
+  size_t index = (aPointer != nullptr ? sFibonacci->getBlockIndex(aPointer) : cCacheIndexCount);
+  if(index < cCacheIndexCount) {
+    ThreadCache& cache = getThreadCache();
+    size_t& count = cache.mCounts[index];
+    if(!sFibonacci->setCached(aPointer, true)) { // double free, the header still tells allocated, but the block is in a cache of any thread
+      tInterface::badAlloc();
+    }
+    else {
+      if(count == cCacheDepth) {
+        uncache(cache.mBlocks[index] + cCacheDepth - cCacheBatch, cCacheBatch);
+        count -= cCacheBatch;
+      }
+      else { // nothing to do
+      }
+      cache.mBlocks[index][count] = aPointer;
+      ++count;
+    }
+  }
+  else {
+    deallocateBlock(aPointer);
+  }
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::flushThreadCache(ThreadCache& aCache) {
+  if(sFibonacci != nullptr && aCache.mGeneration == sGeneration.load(std::memory_order_acquire)) {
+    for(size_t i = 0u; i < cCacheIndexCount; ++i) {
+      uncache(aCache.mBlocks[i], aCache.mCounts[i]);
+      aCache.mCounts[i] = 0u;
+    }
+  }
+  else { // nothing to do
+  }
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+typename NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::ThreadCache& NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::getThreadCache() noexcept {
+  ThreadCache& cache = sThreadCache;
+  size_t const generation = sGeneration.load(std::memory_order_acquire);
+  if(cache.mGeneration != generation) { // contains blocks of a previous heap
+    std::fill(cache.mCounts, cache.mCounts + cCacheIndexCount, 0u);
+    cache.mGeneration = generation;
+  }
+  else { // nothing to do
+  }
+  return cache;
+}
+
+/// Splits the memory into tShardCount independent FibonacciMemoryManager arenas, each having its own lock.
+/// A thread allocates from its home arena, assigned round-robin on its first allocation, and falls back
+/// to the other arenas if that one is exhausted. Deallocation finds the owning arena by address.
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, size_t tShardCount, uintptr_t tMemory = 0u, typename tConfig = FibonacciConfig>
+class ShardedNewDelete final : public FibonacciObjects<ShardedNewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tShardCount, tMemory, tConfig>> {
+  static_assert(tShardCount > 0u, "There must be at least one arena.");
+  static_assert(tConfig::cThreadCacheDepth == 0u, "Thread caches are only supported by NewDelete.");
+  static_assert(tConfig::cGrowthRegionCount == 0u, "Growth is only supported by NewDelete.");
+
+private:
+  static constexpr size_t cArenaSize = tMemorySize / tShardCount / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+  typedef FibonacciMemoryManager<tInterface, cArenaSize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, 0u, FibonacciArenaConfig<tConfig>> Arena;
+
+  typedef FibonacciObjects<ShardedNewDelete> Objects;
+
+  template<typename, typename> friend struct FibonacciWrapper;
+
+  static uint8_t*            sMemory;
+  static Arena*              sArenas[tShardCount];
+  static std::atomic<size_t> sNextArena;
+
+public:
+  static void init(bool const aExactAllocation) { 
+    init(reinterpret_cast<void*>(tMemory), aExactAllocation);
+  }
+
+  static void init(void* aMemory, bool const aExactAllocation) { 
+    sMemory = static_cast<uint8_t*>(aMemory);
+    for(size_t i = 0u; i < tShardCount; ++i) {
+      void* arenaMemory = sMemory + i * cArenaSize;
+      sArenas[i] = new(arenaMemory) Arena(arenaMemory, aExactAllocation);
+    }
+  }
+
+  using Objects::_new;
+  using Objects::_newArray;
+  using Objects::_delete;
+  using Objects::_deleteArray;
+
+  static size_t getFreeSpace() noexcept {
+    size_t result = 0u;
+    for(size_t i = 0u; i < tShardCount; ++i) {
+      result += sArenas[i]->getFreeSpace();
+    }
+    return result;
+  }
+
+  /// Returns the size of the largest block of one arena when nothing has been allocated.
+  static size_t getMaxUserBlockSize() noexcept {
+    return sArenas[0u]->getMaxUserBlockSize();
+  }
+
+  static size_t getMaxFreeUserBlockSize() noexcept {
+    size_t result = 0u;
+    for(size_t i = 0u; i < tShardCount; ++i) {
+      result = std::max(result, sArenas[i]->getMaxFreeUserBlockSize());
+    }
+    return result;
+  }
+
+  static size_t getAlignment() noexcept {
+    return Arena::getAlignment();
+  }
+
+  static void coalesce() noexcept {
+    for(size_t i = 0u; i < tShardCount; ++i) {
+      sArenas[i]->coalesce();
+    }
+  }
+
+  static bool isCorrectEmpty() noexcept {
+    bool result = true;
+    for(size_t i = 0u; i < tShardCount; ++i) {
+      sArenas[i]->coalesce();
+      result = sArenas[i]->isCorrectEmpty() && result;
+    }
+    return result;
+  }
+
+  /// Sums the statistics of the arenas. The peak is the sum of the arena peaks, so it is an upper bound.
+  /// Failures include the requests a home arena could not serve before falling back to the others.
+  static typename Arena::Statistics getStatistics() noexcept {
+    typename Arena::Statistics result = sArenas[0u]->getStatistics();
+    for(size_t i = 1u; i < tShardCount; ++i) {
+      result.add(sArenas[i]->getStatistics());
+    }
+    return result;
+  }
+
+private:
+  static size_t getHomeArena() noexcept {
+    static thread_local size_t home = sNextArena.fetch_add(1u, std::memory_order_relaxed) % tShardCount;
+    return home;
+  }
+
+  static void* allocate(size_t const aSize) {
+    size_t home = getHomeArena();
+    void* result = nullptr;
+    for(size_t i = 0u; i < tShardCount && result == nullptr; ++i) {
+      result = sArenas[(home + i) % tShardCount]->tryAllocate(aSize);
+    }
+    if(result == nullptr) {
+      tInterface::badAlloc();
+    }
+    else { // nothing to do
+    }
+    return result;
+  }
+
+  static void deallocate(void* const aPointer) {
+    if(aPointer != nullptr) {
+      uint8_t* pointer = static_cast<uint8_t*>(aPointer);
+      size_t index = (pointer >= sMemory ? static_cast<size_t>(pointer - sMemory) / cArenaSize : tShardCount);
+      if(index < tShardCount) {
+        sArenas[index]->deallocate(aPointer);
+      }
+      else {
+        tInterface::badAlloc();
+      }
+    }
+    else { // nothing to do
+    }
+  }
+};
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, size_t tShardCount, uintptr_t tMemory, typename tConfig>
+uint8_t* ShardedNewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tShardCount, tMemory, tConfig>::sMemory;
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, size_t tShardCount, uintptr_t tMemory, typename tConfig>
+typename ShardedNewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tShardCount, tMemory, tConfig>::Arena* ShardedNewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tShardCount, tMemory, tConfig>::sArenas[tShardCount];
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, size_t tShardCount, uintptr_t tMemory, typename tConfig>
+std::atomic<size_t> ShardedNewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tShardCount, tMemory, tConfig>::sNextArena;
+
+/// Describes a memory region of RegionNewDelete: its size and, if known at compile time, its address.
+template <size_t tMemorySize, uintptr_t tMemory = 0u>
+struct FibonacciRegion final {
+  static constexpr size_t    cMemorySize = tMemorySize;
+  static constexpr uintptr_t cMemory     = tMemory;
+};
+
+/// Manages several disjoint memory regions, like the TCM and SRAM banks of an MCU, each by its own
+/// FibonacciMemoryManager having its own lock. Allocation tries the hinted region if any, then chooses
+/// among the others by tPlacement. Deallocation finds the owning region by binary search on the addresses.
+template <typename tInterface, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, FibonacciPlacement tPlacement, typename tConfig, typename ...tRegions>
+class RegionNewDelete final : public FibonacciObjects<RegionNewDelete<tInterface, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tPlacement, tConfig, tRegions...>> {
+  static_assert(sizeof...(tRegions) > 0u, "There must be at least one region.");
+  static_assert(tConfig::cThreadCacheDepth == 0u, "Thread caches are only supported by NewDelete.");
+  static_assert(tConfig::cGrowthRegionCount == 0u, "Growth is only supported by NewDelete.");
+
+private:
+  typedef FibonacciObjects<RegionNewDelete> Objects;
+
+  template<typename, typename> friend struct FibonacciWrapper;
+
+  static constexpr size_t cRegionCount = sizeof...(tRegions);
+
+  template <typename tRegion>
+  using Manager = FibonacciMemoryManager<tInterface, tRegion::cMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, 0u, FibonacciArenaConfig<tConfig>>;
+
+  /// Forwards to a manager of the given type, so regions of different sizes can be kept in one array.
+  template <typename tManager>
+  struct Operations final {
+    static void* tryAllocate(void* const aManager, size_t const aSize) {
+      return static_cast<tManager*>(aManager)->tryAllocate(aSize);
+    }
+
+    static void deallocate(void* const aManager, void* const aPointer) {
+      static_cast<tManager*>(aManager)->deallocate(aPointer);
+    }
+
+    static size_t getFreeSpace(void const * const aManager) noexcept {
+      return static_cast<tManager const*>(aManager)->getFreeSpace();
+    }
+
+    static size_t getMaxUserBlockSize(void const * const aManager) noexcept {
+      return static_cast<tManager const*>(aManager)->getMaxUserBlockSize();
+    }
+
+    static size_t getMaxFreeUserBlockSize(void const * const aManager) noexcept {
+      return static_cast<tManager const*>(aManager)->getMaxFreeUserBlockSize();
+    }
+
+    static void coalesce(void* const aManager) noexcept {
+      static_cast<tManager*>(aManager)->coalesce();
+    }
+
+    static bool isCorrectEmpty(void const * const aManager) noexcept {
+      return static_cast<tManager const*>(aManager)->isCorrectEmpty();
+    }
+  };
+
+  struct Region final {
+    uint8_t* mStart;
+    uint8_t* mEnd;
+    void*    mManager;
+    void*    (*mTryAllocate)(void* const aManager, size_t const aSize);
+    void     (*mDeallocate)(void* const aManager, void* const aPointer);
+    size_t   (*mGetFreeSpace)(void const * const aManager);
+    size_t   (*mGetMaxUserBlockSize)(void const * const aManager);
+    size_t   (*mGetMaxFreeUserBlockSize)(void const * const aManager);
+    void     (*mCoalesce)(void* const aManager);
+    bool     (*mIsCorrectEmpty)(void const * const aManager);
+  };
+
+  static std::array<Region, cRegionCount> sRegions;      // in declaration order
+  static std::array<size_t, cRegionCount> sAddressOrder; // indices of sRegions by increasing start address
+
+  /// Passed to the placement forms of operator new of FibonacciWrapper.
+  struct Hint final {
+    size_t mRegion;
+  };
+
+public:
+  /// Uses the addresses given in tRegions.
+  static void init(bool const aExactAllocation) {
+    void* memories[cRegionCount] = { reinterpret_cast<void*>(tRegions::cMemory)... };
+    init(memories, aExactAllocation);
+  }
+
+  /// aMemories contains the start of each region in the order of tRegions.
+  static void init(void* const * const aMemories, bool const aExactAllocation) {
+    init(aMemories, aExactAllocation, std::index_sequence_for<tRegions...>());
+  }
+
+  using Objects::_new;
+  using Objects::_newArray;
+  using Objects::_delete;
+  using Objects::_deleteArray;
+
+  /// Like _new, but tries the region aRegion first, and the others by tPlacement only if it is full.
+  /// The object can be deleted using _delete.
+  template<typename tClass, typename ...tParameters>
+  static tClass* _newIn(size_t const aRegion, tParameters&&... aParameters) {
+    return Objects::template newPlaced<tClass>(Hint{aRegion}, std::forward<tParameters>(aParameters)...);
+  }
+
+  /// Like _newArray, but tries the region aRegion first. The array can be deleted using _deleteArray.
+  template<typename tClass>
+  static tClass* _newArrayIn(size_t const aRegion, size_t const aCount) {
+    return Objects::template newArrayPlaced<tClass>(Hint{aRegion}, aCount);
+  }
+
+  static constexpr size_t getRegionCount() noexcept {
+    return cRegionCount;
+  }
+
+  /// @returns the index of the region containing aPointer in the order of tRegions, or getRegionCount() if there is none.
+  static size_t getRegion(void const * const aPointer) noexcept {
+    uint8_t const * const pointer = static_cast<uint8_t const*>(aPointer);
+    auto next = std::upper_bound(sAddressOrder.cbegin(), sAddressOrder.cend(), pointer, [](uint8_t const * const aValue, size_t const aRegion) {
+      return aValue < sRegions[aRegion].mStart;
+    });
+    size_t result = cRegionCount;
+    if(next != sAddressOrder.cbegin() && pointer < sRegions[*(next - 1)].mEnd) {
+      result = *(next - 1);
+    }
+    else { // nothing to do
+    }
+    return result;
+  }
+
+  static size_t getFreeSpace() noexcept {
+    size_t result = 0u;
+    for(auto const& region : sRegions) {
+      result += region.mGetFreeSpace(region.mManager);
+    }
+    return result;
+  }
+
+  static size_t getFreeSpace(size_t const aRegion) noexcept {
+    return sRegions[aRegion].mGetFreeSpace(sRegions[aRegion].mManager);
+  }
+
+  /// Returns the size of the largest block of any region when nothing has been allocated.
+  static size_t getMaxUserBlockSize() noexcept {
+    size_t result = 0u;
+    for(auto const& region : sRegions) {
+      result = std::max(result, region.mGetMaxUserBlockSize(region.mManager));
+    }
+    return result;
+  }
+
+  static size_t getMaxFreeUserBlockSize() noexcept {
+    size_t result = 0u;
+    for(auto const& region : sRegions) {
+      result = std::max(result, region.mGetMaxFreeUserBlockSize(region.mManager));
+    }
+    return result;
+  }
+
+  static size_t getAlignment() noexcept {
+    return tAlignment;
+  }
+
+  static void coalesce() noexcept {
+    for(auto const& region : sRegions) {
+      region.mCoalesce(region.mManager);
+    }
+  }
+
+  static bool isCorrectEmpty() noexcept {
+    bool result = true;
+    for(auto const& region : sRegions) {
+      region.mCoalesce(region.mManager);
+      result = region.mIsCorrectEmpty(region.mManager) && result;
+    }
+    return result;
+  }
+
+private:
+  template<size_t ...tIndices>
+  static void init(void* const * const aMemories, bool const aExactAllocation, std::index_sequence<tIndices...>) {
+    sRegions = {{ makeRegion<tRegions>(aMemories[tIndices], aExactAllocation)... }};
+    std::iota(sAddressOrder.begin(), sAddressOrder.end(), 0u);
+    std::sort(sAddressOrder.begin(), sAddressOrder.end(), [](size_t const aLeft, size_t const aRight) {
+      return sRegions[aLeft].mStart < sRegions[aRight].mStart;
+    });
+  }
+
+  template<typename tRegion>
+  static Region makeRegion(void* const aMemory, bool const aExactAllocation) {
+    typedef Manager<tRegion> RegionManager;
+    typedef Operations<RegionManager> RegionOperations;
+    uint8_t* start = static_cast<uint8_t*>(aMemory);
+    return Region { start, start + tRegion::cMemorySize, new(aMemory) RegionManager(aMemory, aExactAllocation),
+                    &RegionOperations::tryAllocate, &RegionOperations::deallocate, &RegionOperations::getFreeSpace,
+                    &RegionOperations::getMaxUserBlockSize, &RegionOperations::getMaxFreeUserBlockSize, &RegionOperations::coalesce, &RegionOperations::isCorrectEmpty };
+  }
+
+  static void* tryAllocate(size_t const aRegion, size_t const aSize) {
+    return sRegions[aRegion].mTryAllocate(sRegions[aRegion].mManager, aSize);
+  }
+
+  static void* allocate(size_t const aSize) {
+    return allocate(aSize, cRegionCount);
+  }
+
+  static void* allocate(size_t const aSize, Hint const aHint) {
+    return allocate(aSize, aHint.mRegion);
+  }
+
+  /// aHint is a region to try first, or cRegionCount for none.
+  static void* allocate(size_t const aSize, size_t const aHint) {
+    std::array<bool, cRegionCount> tried {};
+    void* result = nullptr;
+    if(aHint < cRegionCount) {
+      tried[aHint] = true;
+      result = tryAllocate(aHint, aSize);
+    }
+    else { // nothing to do
+    }
+    if(tPlacement == FibonacciPlacement::cSmallestFit) {
+      size_t best = 0u;
+      while(result == nullptr && best < cRegionCount) {
+        size_t bestSize = std::numeric_limits<size_t>::max();
+        best = cRegionCount;
+        for(size_t i = 0u; i < cRegionCount; ++i) {
+          size_t size = sRegions[i].mGetMaxFreeUserBlockSize(sRegions[i].mManager);
+          if(!tried[i] && size >= aSize && size < bestSize) {
+            best = i;
+            bestSize = size;
+          }
+          else { // nothing to do
+          }
+        }
+        if(best < cRegionCount) {
+          tried[best] = true;
+          result = tryAllocate(best, aSize);
+        }
+        else { // nothing to do
+        }
+      }
+    }
+    else { // nothing to do
+    }
+    for(size_t i = 0u; i < cRegionCount && result == nullptr; ++i) { // also catches blocks which lazy coalescing would merge
+      result = (tried[i] ? nullptr : tryAllocate(i, aSize));
+    }
+    if(result == nullptr) {
+      tInterface::badAlloc();
+    }
+    else { // nothing to do
+    }
+    return result;
+  }
+
+  static void deallocate(void* const aPointer) {
+    if(aPointer != nullptr) {
+      size_t region = getRegion(aPointer);
+      if(region < cRegionCount) {
+        sRegions[region].mDeallocate(sRegions[region].mManager, aPointer);
+      }
+      else {
+        tInterface::badAlloc();
+      }
+    }
+    else { // nothing to do
+    }
+  }
+};
+
+template <typename tInterface, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, FibonacciPlacement tPlacement, typename tConfig, typename ...tRegions>
+std::array<typename RegionNewDelete<tInterface, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tPlacement, tConfig, tRegions...>::Region, RegionNewDelete<tInterface, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tPlacement, tConfig, tRegions...>::cRegionCount> RegionNewDelete<tInterface, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tPlacement, tConfig, tRegions...>::sRegions;
+
+template <typename tInterface, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, FibonacciPlacement tPlacement, typename tConfig, typename ...tRegions>
+std::array<size_t, RegionNewDelete<tInterface, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tPlacement, tConfig, tRegions...>::cRegionCount> RegionNewDelete<tInterface, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tPlacement, tConfig, tRegions...>::sAddressOrder;
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+constexpr typename FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::Tables FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::cTables;
+
+/// This class may be instantiated on the beginning of aMemory using placement new.
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::FibonacciMemoryManager(void* aMemory, bool const aExactAllocation) 
+  : mExactAllocation(aExactAllocation) {
+  bool failed = false;
+  mBlockSize = tMinimalBlockSize;
+  mFibonacciCount = cMaxFibonacciCount; // the largest one fitting tMemorySize with tMinimalBlockSize
+  if(reinterpret_cast<uintptr_t>(aMemory) % alignof(std::max_align_t) == 0u) {
+    if(!tConfig::cIntrusiveFreeLists) {
+      mSetNodeSize = AllocatorBlockGauge<std::set<void*>>::getNodeSize(alignToMax(static_cast<uint8_t*>(aMemory) + sizeof(*this)), nullptr);
+    }
+    else { // nothing to do
+    }
+  }
+  else {
+    failed = true;
+  }
+  if(!failed && mFibonacciCount > 2u + tFibonacciIndexDifference) {
+    size_t headerSize = calculateTotalHeaderSize(mFibonacciCount);
+    mBlockSize = calculateBlockSize(headerSize, mFibonacciCount);
+    while(!failed && (headerSize > tMemorySize || tMemorySize - mBlockSize * cTables.mFibonaccis[mFibonacciCount - 1u] < headerSize || mBlockSize < tMinimalBlockSize)) {
+      --mFibonacciCount;
+      if(mFibonacciCount > 2u + tFibonacciIndexDifference) {
+        mBlockSize = calculateBlockSize(headerSize, mFibonacciCount);
+        headerSize = calculateTotalHeaderSize(mFibonacciCount);
+      }
+      else {
+        failed = true;
+      }
+    }
+  }
+  else {
+    failed = true;
+  }
+  if(!failed) {
+    mBlockShift = getHighestSetBit(mBlockSize);
+    initInternalData(aMemory);
+    mSlabIndex = (cSlabEnabled ? getSuitableIndex(tConfig::cSlabSize) : mFibonacciCount);
+  }
+  else { // nothing to do
+    tInterface::badAlloc();
+  }
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>* FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::attach(void* aMemory, bool const aShared) {
+  static_assert(tConfig::cPositionIndependent, "Only a position independent heap can be attached.");
+  FibonacciMemoryManager* result = static_cast<FibonacciMemoryManager*>(aMemory);
+  if(reinterpret_cast<uintptr_t>(aMemory) % alignof(std::max_align_t) == 0u && result->mSignature == getImageSignature() && result->mReady) {
+    if(!aShared) {
+      result->resetLocks();
+    }
+    else { // nothing to do
+    }
+  }
+  else {
+    result = nullptr;
+    tInterface::badAlloc();
+  }
+  return result;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::resetLocks() noexcept {
+  new(&mLock) typename tConfig::InstanceLock();
+  for(auto& lock : mLevelLocks) {
+    new(&lock) LevelLock();
+  }
+  for(auto& lock : mSlabLocks) {
+    new(&lock) LevelLock();
+  }
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+size_t FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::getLargestFreeIndex() const noexcept {
+  size_t fibonacciIndex = mFibonacciCount;
+  for(size_t word = cBitmapWords - 1u; word < cBitmapWords; --word) {
+    size_t bits = mOccupied[word].load(std::memory_order_relaxed);
+    if(bits != 0u) {
+      fibonacciIndex = word * cBitsPerWord + getHighestSetBit(bits);
+      break;
+    }
+    else { // nothing to do
+    }
+  }
+  return fibonacciIndex;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+size_t FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::getSuitableIndex(size_t const aSize) const noexcept {
+  size_t smallestSuitableIndex = mFibonacciCount;
+  size_t sizeWithHeader = aSize + cHeaderSize;
+  if(sizeWithHeader >= aSize && aSize > 0u) {
+    size_t sizeInUnitBlocks = tConfig::cPowerOfTwoBlockSize
+      ? (sizeWithHeader + mBlockSize - 1u) >> mBlockShift
+      : (sizeWithHeader + mBlockSize - 1u) / mBlockSize;
+    smallestSuitableIndex = std::min(cTables.getIndex(sizeInUnitBlocks), mFibonacciCount);
+  }
+  else { // nothing to do
+  }
+  return smallestSuitableIndex;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+size_t FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::getBlockIndex(void const * const aPointer) const noexcept {
+  uint8_t* blockStart = (findSlab(aPointer) != nullptr ? nullptr : getBlockStart(aPointer));
+  return blockStart != nullptr && blockStart + cHeaderSize == aPointer && !getHeader(blockStart)->isFree() ? getHeader(blockStart)->getIndex() : mFibonacciCount;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+size_t FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::getUsableSize(void const * const aPointer) const noexcept {
+  uint8_t const * const pointer = static_cast<uint8_t const*>(aPointer);
+  Slab const* slab = findSlab(aPointer);
+  uint8_t* blockStart = (slab != nullptr ? nullptr : getBlockStart(aPointer));
+  size_t result = 0u;
+  if(slab != nullptr) {
+    size_t slotSize = getSlotSize(slab->mClass);
+    result = slotSize - static_cast<size_t>(pointer - reinterpret_cast<uint8_t const*>(slab) - cSlabHeaderSize) % slotSize;
+  }
+  else if(blockStart != nullptr && !getHeader(blockStart)->isFree()) {
+    result = static_cast<size_t>(blockStart + mBlockSize * cTables.mFibonaccis[getHeader(blockStart)->getIndex()] - pointer);
+  }
+  else { // nothing to do
+  }
+  return result;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void* FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::allocate(size_t const aSize) {
+  void* pointer = tryAllocate(aSize);
+  if(pointer == nullptr) {
+    tInterface::badAlloc();
+  }
+  else { // nothing to do
+  }
+  return pointer;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void* FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::tryAllocate(size_t const aSize) {
+  lock();
+  drainRemoteFrees();
+  void* pointer = (cSlabEnabled && aSize > 0u && aSize <= cMaxSlotSize ? allocateSlot(aSize) : nullptr);
+  if(pointer == nullptr) {
+    pointer = allocateInternal(aSize);
+  }
+  else { // nothing to do
+  }
+  unlock();
+  return pointer;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void* FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::allocateAligned(size_t const aSize, size_t const aAlignment) {
+  void* pointer = tryAllocateAligned(aSize, aAlignment);
+  if(pointer == nullptr) {
+    tInterface::badAlloc();
+  }
+  else { // nothing to do
+  }
+  return pointer;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void* FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::tryAllocateAligned(size_t const aSize, size_t const aAlignment) {
+  void* pointer = nullptr;
+  if(aAlignment <= tAlignment) {
+    pointer = tryAllocate(aSize);
+  }
+  else if(countSetBits(aAlignment) == 1u) {
+    lock();
+    drainRemoteFrees();
+    pointer = allocateAlignedInternal(aSize, aAlignment);
+    unlock();
+  }
+  else { // nothing to do
+  }
+  return pointer;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::deallocate(void* const aPointer) {
+  bool valid = true;
+  if(aPointer == nullptr) { // nothing to do
+  }
+  else if(tConfig::cRemoteFree && !mLock.try_lock()) {
+    valid = pushRemoteFree(aPointer, 0u);
+  }
+  else {
+    if(!tConfig::cRemoteFree) {
+      lock();
+    }
+    else { // try_lock has succeeded
+    }
+    valid = drainRemoteFrees();
+    valid = deallocateInternal(aPointer) && valid;
+    unlock();
+  }
+  if(!valid) {
+    tInterface::badAlloc();
+  }
+  else { // nothing to do
+  }
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::deallocate(void* const aPointer, size_t const aSize) {
+  bool valid = true;
+  if(aPointer == nullptr) { // nothing to do
+  }
+  else if(tConfig::cRemoteFree && !mLock.try_lock()) {
+    valid = pushRemoteFree(aPointer, aSize);
+  }
+  else { // try_lock has taken the lock with cRemoteFree
+    if(!tConfig::cRemoteFree) {
+      lock();
+    }
+    else { // nothing to do
+    }
+    valid = drainRemoteFrees();
+    valid = deallocateInternal(aPointer, aSize) && valid;
+    unlock();
+  }
+  if(!valid) {
+    tInterface::badAlloc();
+  }
+  else { // nothing to do
+  }
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void* FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::reallocate(void* const aPointer, size_t const aSize) {
+  void* result = nullptr;
+  if(aPointer == nullptr) {
+    result = allocate(aSize);
+  }
+  else if(aSize == 0u) {
+    deallocate(aPointer);
+  }
+  else {
+    result = tryReallocate(aPointer, aSize);
+    if(result == nullptr) {
+      tInterface::badAlloc();
+    }
+    else { // nothing to do
+    }
+  }
+  return result;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void* FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::tryReallocate(void* const aPointer, size_t const aSize) noexcept {
+  void* result = nullptr;
+  lock();
+  drainRemoteFrees();
+  Slab* slab = findSlab(aPointer);
+  size_t oldSize = 0u; // usable from aPointer
+  if(slab != nullptr && aSize <= getSlotSize(slab->mClass)) { // the slot is kept as long as the size fits
+    result = aPointer;
+  }
+  else if(slab != nullptr) { // slots never grow in place
+    oldSize = getSlotSize(slab->mClass);
+    result = (aSize <= cMaxSlotSize ? allocateSlot(aSize) : nullptr);
+    if(result == nullptr) {
+      result = allocateInternal(aSize);
+    }
+    else { // nothing to do
+    }
+  }
+  else {
+    uint8_t* blockStart = getBlockStart(aPointer);
+    bool valid = (blockStart != nullptr && !getHeader(blockStart)->isFree());
+    size_t oldIndex = (valid ? getHeader(blockStart)->getIndex() : mFibonacciCount);
+    size_t shift = (valid ? static_cast<size_t>(static_cast<uint8_t*>(aPointer) - blockStart) - cHeaderSize : 0u); // of over-aligned payloads
+    size_t smallestSuitableIndex = (aSize + shift >= aSize ? getSuitableIndex(aSize + shift) : mFibonacciCount);
+    if(valid && smallestSuitableIndex < mFibonacciCount && growInPlace(blockStart, smallestSuitableIndex)) {
+      shrinkInPlace(blockStart, smallestSuitableIndex);
+      countDeallocation(oldIndex);
+      countAllocation(getHeader(blockStart)->getIndex(), aSize);
+      result = aPointer;
+    }
+    else if(valid) {
+      oldSize = getUserBlockSize(oldIndex) - shift;
+      result = allocateInternal(aSize);
+    }
+    else { // nothing to do
+    }
+  }
+  if(result != nullptr && result != aPointer) { // still under the lock, so the old pointer needs no second drain
+    std::memcpy(result, aPointer, std::min(oldSize, aSize));
+    deallocateInternal(aPointer);
+  }
+  else { // nothing to do
+  }
+  unlock();
+  return result;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+size_t FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::allocateBulk(size_t const aSize, size_t const aCount, void** const aPointers) {
+  size_t count = 0u;
+  size_t smallestSuitableIndex = getSuitableIndex(aSize);
+  if(smallestSuitableIndex < mFibonacciCount) {
+    lock();
+    drainRemoteFrees();
+    while(count < aCount) {
+      size_t fibonacciIndex;
+      uint8_t* block = selectBlock(smallestSuitableIndex, fibonacciIndex);
+      if(block != nullptr) {
+        count += splitBulk(block, smallestSuitableIndex, aCount - count, aPointers + count);
+      }
+      else {
+        break;
+      }
+    }
+    unlock();
+  }
+  else { // nothing to do
+  }
+  if(tConfig::cStatistics) {
+    mCounters.mRequestedBytes.fetch_add(aSize * count, std::memory_order_relaxed);
+    mCounters.mFailures.fetch_add(count < aCount ? 1u : 0u, std::memory_order_relaxed);
+  }
+  else { // nothing to do
+  }
+  return count;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::deallocateBulk(void* const * const aPointers, size_t const aCount) {
+  void* sorted[cBulkSortChunk];
+  lock();
+  bool valid = drainRemoteFrees();
+  for(size_t done = 0u; done < aCount; done += cBulkSortChunk) {
+    size_t chunk = (aCount - done < cBulkSortChunk ? aCount - done : cBulkSortChunk);
+    std::copy(aPointers + done, aPointers + done + chunk, sorted);
+    std::sort(sorted, sorted + chunk, std::less<void*>());
+    for(size_t i = 0u; i < chunk; ++i) {
+      if(sorted[i] != nullptr) {
+        valid = deallocateInternal(sorted[i]) && valid;
+      }
+      else { // nothing to do
+      }
+    }
+  }
+  unlock();
+  if(!valid) {
+    tInterface::badAlloc();
+  }
+  else { // nothing to do
+  }
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+bool FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::pushRemoteFree(void* const aPointer, size_t const aSize) noexcept {
+  Slab* slab = findSlab(aPointer, aSize);
+  uint8_t* blockStart = (slab != nullptr ? nullptr : getBlockStart(aPointer));
+  bool valid;
+  if(slab != nullptr) {
+    size_t slot = getSlot(slab, aPointer);
+    size_t const bit = static_cast<size_t>(1u) << (slot % cBitsPerWord);
+    valid = aSize <= getSlotSize(slab->mClass) && slot < cSlabBitmapWords * cBitsPerWord
+         && (slab->mRemote[slot / cBitsPerWord].fetch_or(bit, std::memory_order_relaxed) & bit) == 0u;
+  }
+  else {
+    valid = blockStart != nullptr && (aSize == 0u || static_cast<uint8_t*>(aPointer) + aSize <= blockStart + mBlockSize * cTables.mFibonaccis[getHeader(blockStart)->getIndex()])
+         && getHeader(blockStart)->markRemote();
+  }
+  if(valid) {
+    linkRemoteFree(aPointer);
+  }
+  else { // nothing to do
+  }
+  return valid;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+bool FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::isRemote(Slab const* const aSlab, uint8_t* const aBlockStart, void const * const aPointer) const noexcept {
+  bool result = false;
+  if(!tConfig::cRemoteFree) { // nothing to do
+  }
+  else if(aSlab != nullptr) {
+    size_t slot = getSlot(aSlab, aPointer);
+    result = slot < cSlabBitmapWords * cBitsPerWord && (aSlab->mRemote[slot / cBitsPerWord].load(std::memory_order_relaxed) & (static_cast<size_t>(1u) << (slot % cBitsPerWord))) != 0u;
+  }
+  else if(aBlockStart != nullptr) {
+    result = getHeader(aBlockStart)->isRemote();
+  }
+  else { // nothing to do
+  }
+  return result;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::clearRemote(void const * const aPointer) noexcept {
+  Slab* slab = findSlab(aPointer);
+  if(slab != nullptr) { // pushRemoteFree has checked the slot
+    size_t slot = getSlot(slab, aPointer);
+    slab->mRemote[slot / cBitsPerWord].fetch_and(~(static_cast<size_t>(1u) << (slot % cBitsPerWord)), std::memory_order_relaxed);
+  }
+  else {
+    getHeader(getBlockStart(aPointer))->clearRemote();
+  }
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+bool FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::drainRemoteFrees() noexcept {
+  bool valid = true;
+  if(tConfig::cRemoteFree && mRemoteFrees.load(std::memory_order_relaxed) != 0u) {
+    size_t offset = mRemoteFrees.exchange(0u, std::memory_order_acquire);
+    void* sorted[cBulkSortChunk];
+    while(offset != 0u) {
+      size_t chunk = 0u;
+      while(offset != 0u && chunk < cBulkSortChunk) {
+        sorted[chunk] = mData + (offset - 1u);
+        offset = *static_cast<size_t*>(sorted[chunk]);
+        ++chunk;
+      }
+      std::sort(sorted, sorted + chunk, std::less<void*>());
+      for(size_t i = 0u; i < chunk; ++i) {
+        clearRemote(sorted[i]);
+        valid = deallocateInternal(sorted[i]) && valid;
+      }
+    }
+  }
+  else { // nothing to do
+  }
+  return valid;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void* FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::allocateInternal(size_t const aSize) noexcept {
+  void* pointer = nullptr;
+  if(aSize <= getFreeSpace()) {
+    uint8_t* block = allocateBlock(getSuitableIndex(aSize));
+    if(block != nullptr) {
+      pointer = block + cHeaderSize;
+      countAllocation(getHeader(block)->getIndex(), aSize);
+    }
+    else { // nothing to do
+    }
+  }
+  else { // nothing to do
+  }
+  if(pointer == nullptr) {
+    countEvent(mCounters.mFailures);
+  }
+  else { // nothing to do
+  }
+  return pointer;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void* FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::allocateAlignedInternal(size_t const aSize, size_t const aAlignment) noexcept {
+  uint8_t* payload = nullptr;
+  size_t worstSize = aSize + aAlignment - tAlignment; // enough wherever the block starts
+  if(aSize > 0u && worstSize > aSize && worstSize <= getFreeSpace()) {
+    size_t fibonacciIndex;
+    uint8_t* block = selectBlock(getSuitableIndex(worstSize), fibonacciIndex);
+    if(block != nullptr) {
+      while(fibonacciIndex > tFibonacciIndexDifference) {
+        size_t leftIndex = fibonacciIndex - tFibonacciIndexDifference - 1u;
+        size_t rightIndex = fibonacciIndex - 1u;
+        uint8_t* rightChild = block + mBlockSize * cTables.mFibonaccis[leftIndex];
+        bool leftFits = fitsAligned(block, leftIndex, aSize, aAlignment);
+        if(!leftFits && !fitsAligned(rightChild, rightIndex, aSize, aAlignment)) {
+          break;
+        }
+        else { // nothing to do
+        }
+        BlockHeader* header = getHeader(block);
+        bool buddy = header->getBuddy();
+        bool memory = header->getMemory();
+        bool decommitted = header->isDecommitted();
+        header->set(false, buddy, leftIndex);
+        getHeader(rightChild)->set(true, memory, rightIndex);
+        inheritDecommitted(block, fibonacciIndex, decommitted);
+        countEvent(mCounters.mSplits);
+        if(leftFits) { // the smaller one
+          releaseBlock(rightChild, rightIndex);
+          fibonacciIndex = leftIndex;
+        }
+        else {
+          releaseBlock(block, leftIndex);
+          block = rightChild;
+          fibonacciIndex = rightIndex;
+        }
+      }
+      getHeader(block)->setDecommitted(false);
+      countAllocation(fibonacciIndex, aSize);
+      payload = alignUp(block + cHeaderSize, aAlignment);
+      if(payload != block + cHeaderSize) {
+        markShifted(block, payload);
+      }
+      else { // nothing to do
+      }
+    }
+    else { // nothing to do
+    }
+  }
+  else { // nothing to do
+  }
+  if(payload == nullptr) {
+    countEvent(mCounters.mFailures);
+  }
+  else { // nothing to do
+  }
+  return payload;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+uint8_t* FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::allocateBlock(size_t const aSmallestSuitableIndex) noexcept {
+  size_t fibonacciIndex;
+  uint8_t* parent = selectBlock(aSmallestSuitableIndex, fibonacciIndex);
+  if(parent != nullptr) {  // now fibonacciIndex contains a block size index which perhaps needs to be split
+    while(fibonacciIndex > aSmallestSuitableIndex && allocationDirectionAt(fibonacciIndex, aSmallestSuitableIndex).getDirection() != FibonacciDirection::cHere) {
+      BlockHeader* header = getHeader(parent);
+      bool buddy = header->getBuddy();
+      bool memory = header->getMemory();
+      bool decommitted = header->isDecommitted();
+      size_t leftIndex = fibonacciIndex - tFibonacciIndexDifference - 1u;
+      size_t rightIndex = fibonacciIndex - 1u;
+      uint8_t* leftChild = parent;
+      uint8_t* rightChild = parent + mBlockSize * cTables.mFibonaccis[leftIndex];
+      getHeader(leftChild)->set(false, buddy, leftIndex);
+      getHeader(rightChild)->set(true, memory, rightIndex);
+      inheritDecommitted(parent, fibonacciIndex, decommitted);
+      countEvent(mCounters.mSplits);
+      if(allocationDirectionAt(fibonacciIndex, aSmallestSuitableIndex).getDirection() == FibonacciDirection::cLeft) {
+        releaseBlock(rightChild, rightIndex);
+        parent = leftChild;
+        fibonacciIndex = leftIndex;
+      }
+      else {
+        releaseBlock(leftChild, leftIndex);
+        parent = rightChild;
+        fibonacciIndex = rightIndex;
+      }
+    }
+    getHeader(parent)->setDecommitted(false);
+  }
+  else { // nothing to do
+  }
+  return parent;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+uint8_t* FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::selectBlock(size_t const aSmallestSuitableIndex, size_t& aIndex) noexcept {
+  uint8_t* block = nullptr;
+  aIndex = mFibonacciCount;
+  if(aSmallestSuitableIndex < mFibonacciCount && mExactAllocation) {
+    block = takeFree(aSmallestSuitableIndex, cTables.mExactMasks + aSmallestSuitableIndex * cBitmapWords, aIndex);
+  }
+  else { // nothing to do
+  }
+  if(block == nullptr) {
+    block = takeFree(aSmallestSuitableIndex, nullptr, aIndex);
+  }
+  else { // nothing to do
+  }
+  if(block == nullptr && tConfig::cLazyCoalescing && aSmallestSuitableIndex < mFibonacciCount) {
+    coalesceInternal();
+    block = takeFree(aSmallestSuitableIndex, nullptr, aIndex);
+  }
+  else { // nothing to do
+  }
+  if(block != nullptr) {
+    decreaseFreeSpace(getUserBlockSize(aIndex));
+  }
+  else { // nothing to do
+  }
+  return block;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+size_t FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::splitBulk(uint8_t* const aBlock, size_t const aSmallestSuitableIndex, size_t const aCount, void** const aPointers) noexcept {
+  uint8_t* stack[cMaxFibonacciCount + 1u]; // each split adds one pending right child per level
+  size_t depth = 0u;
+  size_t count = 0u;
+  stack[depth++] = aBlock;
+  while(depth > 0u) {
+    uint8_t* block = stack[--depth];
+    BlockHeader* header = getHeader(block);
+    size_t fibonacciIndex = header->getIndex();
+    if(count == aCount || fibonacciIndex < aSmallestSuitableIndex) {
+      releaseBlock(block, fibonacciIndex);
+    }
+    else if(fibonacciIndex == aSmallestSuitableIndex || allocationDirectionAt(fibonacciIndex, aSmallestSuitableIndex).getDirection() == FibonacciDirection::cHere) {
+      header->setDecommitted(false);
+      aPointers[count] = block + cHeaderSize;
+      ++count;
+      countAllocation(fibonacciIndex, 0u); // allocateBulk adds the requested bytes
+    }
+    else {
+      size_t leftIndex = fibonacciIndex - tFibonacciIndexDifference - 1u;
+      uint8_t* rightChild = block + mBlockSize * cTables.mFibonaccis[leftIndex];
+      bool buddy = header->getBuddy();
+      bool memory = header->getMemory();
+      bool decommitted = header->isDecommitted();
+      getHeader(block)->set(false, buddy, leftIndex);
+      getHeader(rightChild)->set(true, memory, fibonacciIndex - 1u);
+      inheritDecommitted(block, fibonacciIndex, decommitted);
+      countEvent(mCounters.mSplits);
+      stack[depth++] = rightChild;
+      stack[depth++] = block;
+    }
+  }
+  return count;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+bool FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::deallocateInternal(void* const aPointer, size_t const aSize) noexcept {
+  Slab* slab = findSlab(aPointer, aSize); // a slot rejects sizes above cMaxSlotSize
+  uint8_t* blockStart = (slab != nullptr ? nullptr : getBlockStart(aPointer));
+  bool valid = (blockStart != nullptr && !getHeader(blockStart)->isFree()) && !isRemote(slab, blockStart, aPointer); // double frees otherwise
+  if(valid && aSize > 0u) {
+    valid = static_cast<uint8_t*>(aPointer) + aSize <= blockStart + mBlockSize * cTables.mFibonaccis[getHeader(blockStart)->getIndex()];
+  }
+  else { // nothing to do
+  }
+  if(slab != nullptr) {
+    valid = aSize <= getSlotSize(slab->mClass) && !isRemote(slab, nullptr, aPointer) && freeSlot(slab, aPointer);
+  }
+  else if(valid) {
+    countDeallocation(getHeader(blockStart)->getIndex());
+    if(tConfig::cLazyCoalescing) {
+      deferBlock(blockStart);
+    }
+    else {
+      freeBlock(blockStart);
+    }
+  }
+  else { // nothing to do
   }
+  return valid;
+}
 
-  template<typename tClass>
-  static void _deleteArray(tClass* aPointer) {
-    delete[] reinterpret_cast<Wrapper<tClass>*>(aPointer);
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+typename FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::Slab* FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::findSlab(void const * const aPointer) const noexcept {
+  Slab* result = nullptr;
+  size_t unit = (contains(aPointer) ? static_cast<size_t>(static_cast<uint8_t const*>(aPointer) - mData) / mBlockSize : 0u);
+  if(cSlabEnabled && contains(aPointer) && (mSlabUnits[unit / cBitsPerWord].load(std::memory_order_relaxed) & (static_cast<size_t>(1u) << (unit % cBitsPerWord))) != 0u) {
+    size_t word = unit / cBitsPerWord;
+    size_t bits = mSlabStarts[word].load(std::memory_order_relaxed) & (~static_cast<size_t>(0u) >> (cBitsPerWord - 1u - unit % cBitsPerWord));
+    while(bits == 0u) { // the start of this slab is set
+      --word;
+      bits = mSlabStarts[word].load(std::memory_order_relaxed);
+    }
+    result = reinterpret_cast<Slab*>(mData + (word * cBitsPerWord + getHighestSetBit(bits)) * mBlockSize + cHeaderSize);
   }
-  
-  static size_t getFreeSpace() noexcept {
-    return sFibonacci->getFreeSpace();
+  else { // nothing to do
   }
+  return result;
+}
 
-  static size_t getMaxUserBlockSize() noexcept {
-    return sFibonacci->getMaxUserBlockSize();
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::setSlabBits(std::atomic<size_t>* const aBitmap, size_t const aFirst, size_t const aCount, bool const aSet) noexcept {
+  size_t bit = aFirst;
+  size_t const end = aFirst + aCount;
+  while(bit < end) {
+    size_t count = std::min(cBitsPerWord - bit % cBitsPerWord, end - bit);
+    size_t const mask = (count == cBitsPerWord ? ~static_cast<size_t>(0u) : ((static_cast<size_t>(1u) << count) - 1u) << (bit % cBitsPerWord));
+    if(aSet) {
+      aBitmap[bit / cBitsPerWord].fetch_or(mask, std::memory_order_relaxed);
+    }
+    else {
+      aBitmap[bit / cBitsPerWord].fetch_and(~mask, std::memory_order_relaxed);
+    }
+    bit += count;
   }
+}
 
-  static size_t getMaxFreeUserBlockSize() noexcept {
-    return sFibonacci->getMaxFreeUserBlockSize();
-  }
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::markSlab(Slab* const aSlab, bool const aSet) noexcept {
+  uint8_t* block = reinterpret_cast<uint8_t*>(aSlab) - cHeaderSize;
+  size_t unit = static_cast<size_t>(block - mData) / mBlockSize;
+  setSlabBits(mSlabStarts, unit, 1u, aSet);
+  setSlabBits(mSlabUnits, unit, cTables.mFibonaccis[getHeader(block)->getIndex()], aSet);
+}
 
-  static size_t getAlignment() noexcept {
-    return sFibonacci->getAlignment();
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void* FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::allocateSlot(size_t const aSize) noexcept {
+  size_t slabClass = (aSize - 1u) / tAlignment;
+  lockSlabClass(slabClass);
+  Slab* slab = mSlabs[slabClass];
+  if(slab == nullptr && mSlabIndex < mFibonacciCount) {
+    void* memory = allocateInternal(getUserBlockSize(mSlabIndex));
+    if(memory != nullptr) {
+      size_t fibonacciIndex = getHeader(static_cast<uint8_t*>(memory) - cHeaderSize)->getIndex(); // may be larger in exact mode
+      size_t slotCount = std::min((getUserBlockSize(fibonacciIndex) - cSlabHeaderSize) / getSlotSize(slabClass), cSlabBitmapWords * cBitsPerWord);
+      slab = new(memory) Slab();
+      slab->mClass = slabClass;
+      slab->mSlotCount = slotCount;
+      slab->mFreeCount = slotCount;
+      for(size_t i = 0u; i < slotCount / cBitsPerWord; ++i) {
+        slab->mFree[i] = ~static_cast<size_t>(0u);
+      }
+      if(slotCount % cBitsPerWord > 0u) {
+        slab->mFree[slotCount / cBitsPerWord] = (static_cast<size_t>(1u) << (slotCount % cBitsPerWord)) - 1u;
+      }
+      else { // nothing to do
+      }
+      linkSlab(slab);
+      markSlab(slab, true);
+    }
+    else { // nothing to do
+    }
   }
-  
-  static bool isCorrectEmpty() noexcept {
-    return sFibonacci->isCorrectEmpty();
+  else { // nothing to do
   }
-};
-
-template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory>
-FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference>* NewDelete<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory>::sFibonacci;
-
-/// This class may be instantiated on the beginning of aMemory using placement new.
-template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory>
-FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory>::FibonacciMemoryManager(void* aMemory, bool const aExactAllocation) 
-  : mExactAllocation(aExactAllocation) {
-  bool failed = false;
-  mBlockSize = tMinimalBlockSize;
-  size_t* fibonaccis;
-  if(reinterpret_cast<uintptr_t>(aMemory) % alignof(std::max_align_t) == 0u) {
-    void* tmpFree = alignToMax(static_cast<uint8_t*>(aMemory) + sizeof(*this));
-    mSetNodeSize = AllocatorBlockGauge<std::set<void*>>::getNodeSize(tmpFree, nullptr);
-    fibonaccis = static_cast<size_t*>(tmpFree);
-    mFibonacciCount = reinterpret_cast<size_t*>(reinterpret_cast<uint8_t*>(aMemory) + tMemorySize) - fibonaccis;
-    mFibonacciCount = calculateFibonaccis(fibonaccis, mFibonacciCount, tMemorySize);
-    while(tMemorySize / fibonaccis[mFibonacciCount - 1u] < mBlockSize) {
-      --mFibonacciCount;
+  uint8_t* slot = nullptr;
+  if(slab != nullptr) {
+    size_t word = 0u;
+    while(slab->mFree[word] == 0u) {
+      ++word;
+    }
+    size_t bit = countTrailingZeros(slab->mFree[word]);
+    slab->mFree[word] &= ~(static_cast<size_t>(1u) << bit);
+    --slab->mFreeCount;
+    if(slab->mFreeCount == 0u) {
+      unlinkSlab(slab);
+    }
+    else { // nothing to do
     }
+    slot = reinterpret_cast<uint8_t*>(slab) + cSlabHeaderSize + (word * cBitsPerWord + bit) * getSlotSize(slabClass);
   }
-  else {
-    failed = true;
+  else { // nothing to do
   }
-  if(!failed && mFibonacciCount > 2u + tFibonacciIndexDifference) {
-    size_t headerSize = calculateTotalHeaderSize(fibonaccis, mFibonacciCount);
-    mBlockSize = (tMemorySize - headerSize) / fibonaccis[mFibonacciCount - 1u];
-    mBlockSize &= ~(tAlignment - 1u);
-    while(!failed && (headerSize > tMemorySize || tMemorySize - mBlockSize * fibonaccis[mFibonacciCount - 1u] < headerSize || mBlockSize < tMinimalBlockSize)) {
-      --mFibonacciCount;
-      if(mFibonacciCount > 2u + tFibonacciIndexDifference) {
-        mBlockSize = (tMemorySize - headerSize) / fibonaccis[mFibonacciCount - 1u];
-        mBlockSize &= ~(tAlignment - 1u);
-        headerSize = calculateTotalHeaderSize(fibonaccis, mFibonacciCount);
+  unlockSlabClass(slabClass);
+  return slot;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+bool FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::freeSlot(Slab* const aSlab, void* const aPointer) noexcept {
+  Slab* slab = aSlab;
+  size_t slabClass = slab->mClass; // stays while the slab has used slots
+  size_t offset = static_cast<size_t>(static_cast<uint8_t*>(aPointer) - reinterpret_cast<uint8_t*>(slab)) - cSlabHeaderSize; // wraps around for the header
+  size_t slot = offset / getSlotSize(slabClass);
+  size_t slotCount = slab->mSlotCount;
+  bool valid = (offset % getSlotSize(slabClass) == 0u && slot < slotCount);
+  if(valid) {
+    lockSlabClass(slabClass);
+    size_t& word = slab->mFree[slot / cBitsPerWord];
+    size_t const bit = static_cast<size_t>(1u) << (slot % cBitsPerWord);
+    valid = (word & bit) == 0u; // would be a double free otherwise
+    if(valid) {
+      word |= bit;
+      ++slab->mFreeCount;
+      if(slab->mFreeCount == 1u) {
+        linkSlab(slab);
       }
-      else {
-        failed = true;
+      else { // nothing to do
+      }
+      if(slab->mFreeCount == slotCount && (mSlabs[slabClass] != slab || slab->mNext != nullptr)) { // the last one stays as a spare
+        unlinkSlab(slab);
+        releaseSlab(slab);
+      }
+      else { // nothing to do
       }
     }
-  }
-  else {
-    failed = true;
-  }
-  if(!failed) {
-    initInternalData(aMemory);
+    else { // nothing to do
+    }
+    unlockSlabClass(slabClass);
   }
   else { // nothing to do
-    tInterface::badAlloc();
   }
+  return valid;
 }
 
-template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory>
-size_t FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory>::getLargestFreeIndex() const noexcept {
-  size_t fibonacciIndex;
-  for(fibonacciIndex = mFibonacciCount - 1u; fibonacciIndex < mFibonacciCount; --fibonacciIndex) {
-    if(mFreeSets[fibonacciIndex].size() > 0u) {
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::releaseSpareSlabs() noexcept {
+  for(size_t i = 0u; i < cSlabClassCount; ++i) {
+    lockSlabClass(i);
+    Slab* slab = mSlabs[i];
+    while(slab != nullptr) {
+      Slab* next = slab->mNext;
+      if(slab->mFreeCount == slab->mSlotCount) {
+        unlinkSlab(slab);
+        releaseSlab(slab);
+      }
+      else { // nothing to do
+      }
+      slab = next;
+    }
+    unlockSlabClass(i);
+  }
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+bool FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::growInPlace(uint8_t* const aBlockStart, size_t const aSmallestSuitableIndex) noexcept {
+  BlockHeader* header = getHeader(aBlockStart);
+  size_t fibonacciIndex = header->getIndex();
+  bool buddyBit = header->getBuddy();
+  bool memoryBit = header->getMemory();
+  size_t reachableIndex = fibonacciIndex;
+  while(reachableIndex < aSmallestSuitableIndex && reachableIndex < mFibonacciCount - 1u && !buddyBit) { // only left blocks can grow in place
+    BlockHeader* buddyHeader = getHeader(aBlockStart + mBlockSize * cTables.mFibonaccis[reachableIndex]);
+    if(buddyHeader->isFree() && buddyHeader->getIndex() == reachableIndex + tFibonacciIndexDifference) {
+      buddyBit = memoryBit;
+      memoryBit = buddyHeader->getMemory();
+      reachableIndex += tFibonacciIndexDifference + 1u;
+    }
+    else {
       break;
     }
+  }
+  bool result = reachableIndex >= aSmallestSuitableIndex;
+  while(result && fibonacciIndex < aSmallestSuitableIndex) { // can fail only if an other thread takes a buddy in per-index locking
+    size_t buddyIndex = fibonacciIndex + tFibonacciIndexDifference;
+    uint8_t* buddyStart = aBlockStart + mBlockSize * cTables.mFibonaccis[fibonacciIndex];
+    lockLevels(fibonacciIndex, buddyIndex);
+    result = removeFreeBuddy(buddyStart, buddyIndex);
+    unlockLevels(fibonacciIndex, buddyIndex);
+    if(result) {
+      decreaseFreeSpace(getUserBlockSize(buddyIndex));
+      countEvent(mCounters.mMerges);
+      fibonacciIndex += tFibonacciIndexDifference + 1u;
+      header->set(header->getMemory(), getHeader(buddyStart)->getMemory(), fibonacciIndex);
+      getHeader(buddyStart)->setFree(true); // no block starts there any more, as after merging
+    }
     else { // nothing to do
     }
   }
-  return std::min<size_t>(fibonacciIndex, mFibonacciCount);
+  return result;
 }
 
-template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory>
-void* FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory>::allocate(size_t const aSize) {
-  tInterface::lock();
-  size_t smallestSuitableIndex = mFibonacciCount;
-  size_t fibonacciIndex = mFibonacciCount;
-  size_t sizeWithHeader = aSize + tAlignment;
-  bool failed = (sizeWithHeader < tAlignment || aSize == 0u || aSize > mFreeSpace);
-  size_t sizeInUnitBlocks = (sizeWithHeader + mBlockSize - 1u) / mBlockSize;
-  if(!failed) {
-    smallestSuitableIndex = std::upper_bound(mFibonaccis, mFibonaccis + mFibonacciCount, sizeInUnitBlocks) - mFibonaccis;
-    if(smallestSuitableIndex > 0u && mFibonaccis[smallestSuitableIndex - 1u] == sizeInUnitBlocks) {
-      --smallestSuitableIndex;
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::shrinkInPlace(uint8_t* const aBlockStart, size_t const aSmallestSuitableIndex) noexcept {
+  BlockHeader* header = getHeader(aBlockStart);
+  size_t fibonacciIndex = header->getIndex();
+  while(fibonacciIndex >= aSmallestSuitableIndex + tFibonacciIndexDifference + 1u) {
+    size_t leftIndex = fibonacciIndex - tFibonacciIndexDifference - 1u;
+    size_t rightIndex = fibonacciIndex - 1u;
+    uint8_t* rightChild = aBlockStart + mBlockSize * cTables.mFibonaccis[leftIndex];
+    bool buddy = header->getBuddy();
+    bool memory = header->getMemory();
+    header->set(false, buddy, leftIndex);
+    getHeader(rightChild)->set(true, memory, rightIndex);
+    countEvent(mCounters.mSplits);
+    lockLevel(rightIndex); // its buddy is the kept left child
+    pushReleased(rightChild, rightIndex);
+    unlockLevel(rightIndex);
+    increaseFreeSpace(getUserBlockSize(rightIndex));
+    fibonacciIndex = leftIndex;
+  }
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::freeBlock(uint8_t* const aBlockStart) noexcept {
+  uint8_t* blockStart = aBlockStart;
+  BlockHeader* blockHeader = getHeader(blockStart);
+  size_t blockIndex = blockHeader->getIndex();
+  uint8_t* buddyStart = nullptr;
+  size_t   buddyIndex = mFibonacciCount;
+  bool     buddyFound;
+  do {
+    if(blockIndex < mFibonacciCount - 1u) {
+      bool blockBuddyBit = blockHeader->getBuddy();
+      if(blockBuddyBit) {
+        buddyIndex = blockIndex - tFibonacciIndexDifference;
+        buddyStart = blockStart - mBlockSize * cTables.mFibonaccis[buddyIndex];
+      }
+      else {
+        buddyIndex = blockIndex + tFibonacciIndexDifference;
+        buddyStart = blockStart + mBlockSize * cTables.mFibonaccis[blockIndex];
+      }
+      // Holding both locks while checking the buddy and pushing the block lets
+      // two threads freeing the buddies at the same time not miss the merge.
+      lockLevels(blockIndex, buddyIndex);
+      buddyFound = removeFreeBuddy(buddyStart, buddyIndex);
+      if(buddyFound) {
+        unlockLevels(blockIndex, buddyIndex);
+        BlockHeader* buddyHeader = getHeader(buddyStart);
+        decreaseFreeSpace(getUserBlockSize(buddyIndex));
+        countEvent(mCounters.mMerges);
+        BlockHeader* rightHeader = (blockBuddyBit ? blockHeader : buddyHeader);
+        bool leftDecommitted = (blockBuddyBit ? buddyHeader : blockHeader)->isDecommitted(); // only buddies may be, until the first merge with such
+        bool rightDecommitted = rightHeader->isDecommitted();
+        bool blockMemoryBit;
+        if(blockBuddyBit) {
+          blockBuddyBit = buddyHeader->getMemory();
+          blockMemoryBit = blockHeader->getMemory();
+          ++blockIndex;
+          blockStart = buddyStart;
+          blockHeader = buddyHeader;
+        }
+        else {
+          blockBuddyBit = blockHeader->getMemory();
+          blockMemoryBit = buddyHeader->getMemory();
+          blockIndex += tFibonacciIndexDifference + 1u;
+          // block* pointers remain the same
+        }
+        blockHeader->set(blockBuddyBit, blockMemoryBit, blockIndex);
+        rightHeader->setFree(true); // no block starts there any more, but a double free of its payload would find it
+        mergeDecommitted(blockStart, blockIndex, leftDecommitted, rightDecommitted, std::integral_constant<bool, cDecommitEnabled>());
+      }
+      else {
+        pushReleased(blockStart, blockIndex);
+        unlockLevels(blockIndex, buddyIndex);
+      }
     }
-    else { // nothing to do
+    else {
+      lockLevel(blockIndex);
+      pushReleased(blockStart, blockIndex);
+      unlockLevel(blockIndex);
+      buddyFound = false;
     }
+  } while(buddyFound);
+  increaseFreeSpace(getUserBlockSize(blockIndex));
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::deferBlock(uint8_t* const aBlockStart) noexcept {
+  size_t fibonacciIndex = getHeader(aBlockStart)->getIndex();
+  lockLevel(fibonacciIndex);
+  pushReleased(aBlockStart, fibonacciIndex);
+  size_t uncoalesced = mUncoalesced[fibonacciIndex].load(std::memory_order_relaxed) + 1u;
+  mUncoalesced[fibonacciIndex].store(uncoalesced, std::memory_order_relaxed);
+  unlockLevel(fibonacciIndex);
+  increaseFreeSpace(getUserBlockSize(fibonacciIndex));
+  if(uncoalesced > tConfig::cLazyWatermark) {
+    coalesceInternal();
   }
   else { // nothing to do
   }
-  if(!failed && mExactAllocation) {
-    fibonacciIndex = smallestSuitableIndex;
-    while(fibonacciIndex < mFibonacciCount && 
-          (mFreeSets[fibonacciIndex].size() == 0u ||
-          !allocationDirectionAt(fibonacciIndex, smallestSuitableIndex).isExact())) {
-      ++fibonacciIndex;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::coalesce() noexcept {
+  if(tConfig::cLazyCoalescing || cSlabEnabled || tConfig::cRemoteFree) {
+    lock();
+    drainRemoteFrees();
+    releaseSpareSlabs();
+    if(tConfig::cLazyCoalescing) {
+      coalesceInternal();
+    }
+    else { // nothing to do
     }
+    unlock();
   }
   else { // nothing to do
   }
-  if(!failed && fibonacciIndex == mFibonacciCount) {
-    fibonacciIndex = smallestSuitableIndex;
-    while(fibonacciIndex < mFibonacciCount && 
-          mFreeSets[fibonacciIndex].size() == 0u) {
-      ++fibonacciIndex;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::coalesceInternal() noexcept {
+  for(size_t i = 0u; i < mFibonacciCount; ++i) {
+    lockLevel(i);
+  }
+  size_t from = 0u;
+  while(from < mFibonacciCount && mUncoalesced[from].load(std::memory_order_relaxed) == 0u) {
+    ++from;
+  }
+  for(size_t i = from; i < mFibonacciCount; ++i) {
+    mUncoalesced[i].store(0u, std::memory_order_relaxed);
+    if(tConfig::cIntrusiveFreeLists) {
+      uint8_t* block = mFreeLists[i];
+      while(block != nullptr) {
+        uint8_t* next = getLinks(block)->mNext;
+        mergeOnce(block, i);
+        block = next;
+      }
+    }
+    else {
+      auto iterator = mFreeSets[i].begin();
+      while(iterator != mFreeSets[i].end()) {
+        uint8_t* block = *iterator;
+        ++iterator;
+        mergeOnce(block, i);
+      }
+    }
+  }
+  for(size_t i = mFibonacciCount - 1u; i < mFibonacciCount; --i) {
+    unlockLevel(i);
+  }
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::mergeOnce(uint8_t* const aBlock, size_t const aIndex) noexcept {
+  if(aIndex < mFibonacciCount - 1u) {
+    BlockHeader* header = getHeader(aBlock);
+    bool buddyBit = header->getBuddy();
+    size_t buddyIndex;
+    uint8_t* leftStart;
+    uint8_t* rightStart;
+    if(buddyBit) {
+      buddyIndex = aIndex - tFibonacciIndexDifference;
+      leftStart = aBlock - mBlockSize * cTables.mFibonaccis[buddyIndex];
+      rightStart = aBlock;
+    }
+    else {
+      buddyIndex = aIndex + tFibonacciIndexDifference;
+      leftStart = aBlock;
+      rightStart = aBlock + mBlockSize * cTables.mFibonaccis[aIndex];
     }
-    if(fibonacciIndex == mFibonacciCount) {
-      failed = true;
+    if(removeFreeBuddy(buddyBit ? leftStart : rightStart, buddyIndex)) {
+      removeFreeBuddy(aBlock, aIndex);
+      decreaseFreeSpace(getUserBlockSize(aIndex) + getUserBlockSize(buddyIndex));
+      countEvent(mCounters.mMerges);
+      size_t parentIndex = std::max(aIndex, buddyIndex) + 1u;
+      bool leftDecommitted = getHeader(leftStart)->isDecommitted();
+      bool rightDecommitted = getHeader(rightStart)->isDecommitted();
+      getHeader(leftStart)->set(getHeader(leftStart)->getMemory(), getHeader(rightStart)->getMemory(), parentIndex);
+      getHeader(rightStart)->setFree(true); // no block starts there any more, but a double free of its payload would find it
+      mergeDecommitted(leftStart, parentIndex, leftDecommitted, rightDecommitted, std::integral_constant<bool, cDecommitEnabled>());
+      pushReleased(leftStart, parentIndex);
+      increaseFreeSpace(getUserBlockSize(parentIndex));
     }
     else { // nothing to do
     }
   }
   else { // nothing to do
   }
-  void* pointer = nullptr;
-  if(!failed) {             // now fibonacciIndex contains a block size index which perhaps needs to be split
-    auto begin = mFreeSets[fibonacciIndex].begin();
-    void* parent = *begin;
-    mFreeSets[fibonacciIndex].erase(begin);
-    mFreeSpace -= getUserBlockSize(fibonacciIndex);
-    while(fibonacciIndex > smallestSuitableIndex && allocationDirectionAt(fibonacciIndex, smallestSuitableIndex).getDirection() != FibonacciDirection::cHere) {
-      BlockHeader* header = static_cast<BlockHeader*>(parent);
-      bool buddy = header->getBuddy();
-      bool memory = header->getMemory();
-      size_t leftIndex = fibonacciIndex - tFibonacciIndexDifference - 1u;
-      size_t rightIndex = fibonacciIndex - 1u;
-      void* leftChild = parent;
-      void* rightChild = reinterpret_cast<void*>(reinterpret_cast<uint8_t*>(parent) + mBlockSize * mFibonaccis[leftIndex]);
-      static_cast<BlockHeader*>(leftChild)->set(false, buddy, leftIndex);
-      static_cast<BlockHeader*>(rightChild)->set(true, memory, rightIndex);
-      if(allocationDirectionAt(fibonacciIndex, smallestSuitableIndex).getDirection() == FibonacciDirection::cLeft) {
-        mFreeSets[rightIndex].insert(reinterpret_cast<uint8_t*>(rightChild));
-        parent = leftChild;
-        fibonacciIndex = leftIndex;
-        mFreeSpace += getUserBlockSize(rightIndex);
-      }
-      else {
-        mFreeSets[leftIndex].insert(reinterpret_cast<uint8_t*>(leftChild));
-        parent = rightChild;
-        fibonacciIndex = rightIndex;
-        mFreeSpace += getUserBlockSize(leftIndex);
-      }
-    }
-    pointer = reinterpret_cast<void*>(reinterpret_cast<uint8_t*>(parent) + tAlignment);
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+bool FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::isCorrectEmpty() const noexcept {
+  lock();
+  bool result = (getLargestFreeIndex() == mFibonacciCount - 1u && getFreeSpace() == getUserBlockSize(mFibonacciCount - 1u));
+  unlock();
+  return result;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+template<typename tFunction>
+bool FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::callIfEmpty(tFunction aFunction) noexcept {
+  lock();
+  for(size_t i = 0u; i < mFibonacciCount; ++i) {
+    lockLevel(i);
+  }
+  bool result = (getMaxFreeUserBlockSize() == getMaxUserBlockSize());
+  if(result) {
+    aFunction();
   }
   else { // nothing to do
   }
-  if(failed) {
-    tInterface::badAlloc();
+  for(size_t i = mFibonacciCount - 1u; i < mFibonacciCount; --i) {
+    unlockLevel(i);
+  }
+  unlock();
+  return result;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+typename FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::Statistics FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::getStatistics() const noexcept {
+  Statistics result = {};
+  if(tConfig::cStatistics) {
+    result.mIndexCount = mFibonacciCount;
+    for(size_t i = 0u; i < mFibonacciCount; ++i) {
+      result.mAllocations[i] = mCounters.mAllocations[i].load(std::memory_order_relaxed);
+      result.mDeallocations[i] = mCounters.mDeallocations[i].load(std::memory_order_relaxed);
+    }
+    result.mSplits = mCounters.mSplits.load(std::memory_order_relaxed);
+    result.mMerges = mCounters.mMerges.load(std::memory_order_relaxed);
+    result.mFailures = mCounters.mFailures.load(std::memory_order_relaxed);
+    result.mFreeSpace = getFreeSpace();
+    result.mUsed = getMaxUserBlockSize() - result.mFreeSpace;
+    result.mPeakUsed = mCounters.mPeakUsed.load(std::memory_order_relaxed);
+    result.mRequestedBytes = mCounters.mRequestedBytes.load(std::memory_order_relaxed);
+    result.mGrantedBytes = mCounters.mGrantedBytes.load(std::memory_order_relaxed);
+    result.mMaxFreeUserBlockSize = getMaxFreeUserBlockSize();
+    result.mLockNanoseconds = mCounters.mLockNanoseconds.load(std::memory_order_relaxed);
   }
   else { // nothing to do
   }
-  tInterface::unlock();
-  return pointer;
+  return result;
 }
 
-template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory>
-void FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory>::deallocate(void* const aPointer) {
-  tInterface::lock();
-  if(aPointer != nullptr) {
-    uint8_t* blockStart = reinterpret_cast<uint8_t*>(aPointer) - tAlignment;
-    if(reinterpret_cast<uintptr_t>(blockStart) % tAlignment == 0u && blockStart >= mData && blockStart < mData + mBlockSize * mFibonaccis[mFibonacciCount - 1u]) {
-      BlockHeader* blockHeader = reinterpret_cast<BlockHeader*>(blockStart);
-      size_t blockIndex = blockHeader->getIndex();
-      uint8_t* buddyStart = nullptr;
-      size_t   buddyIndex = mFibonacciCount;
-      bool     buddyFound;
-      do {
-        if(blockIndex < mFibonacciCount - 1u) {
-          bool blockBuddyBit = blockHeader->getBuddy();
-          if(blockBuddyBit) {
-            buddyIndex = blockIndex - tFibonacciIndexDifference;
-            buddyStart = blockStart - mBlockSize * mFibonaccis[buddyIndex];
-          }
-          else {
-            buddyIndex = blockIndex + tFibonacciIndexDifference;
-            buddyStart = blockStart + mBlockSize * mFibonaccis[blockIndex];
-          }
-          auto found = mFreeSets[buddyIndex].find(buddyStart);
-          buddyFound = (found != mFreeSets[buddyIndex].end());
-          if(buddyFound) {
-            BlockHeader* buddyHeader = reinterpret_cast<BlockHeader*>(buddyStart);
-            mFreeSets[buddyIndex].erase(found);
-            mFreeSpace -= getUserBlockSize(buddyIndex);
-            bool blockMemoryBit;
-            if(blockBuddyBit) {
-              blockBuddyBit = buddyHeader->getMemory();
-              blockMemoryBit = blockHeader->getMemory();
-              ++blockIndex;
-              blockStart = buddyStart;
-              blockHeader = buddyHeader;
-            }
-            else {
-              blockBuddyBit = blockHeader->getMemory();
-              blockMemoryBit = buddyHeader->getMemory();
-              blockIndex += tFibonacciIndexDifference + 1u;
-              // block* pointers remain the same
-            }
-            blockHeader->set(blockBuddyBit, blockMemoryBit, blockIndex);
-          }
-          else { // nothing to do
-          }
-        }
-        else {
-          buddyFound = false;
-        }
-      } while(buddyFound);
-      mFreeSets[blockIndex].insert(blockStart);
-      mFreeSpace += getUserBlockSize(blockIndex);
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+size_t FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::dump(void* const aBuffer, size_t const aSize) const noexcept {
+  lock();
+  for(size_t i = 0u; i < mFibonacciCount; ++i) {
+    lockLevel(i);
+  }
+  size_t blockCount = 0u;
+  Blocks blocks = getBlocks();
+  for(auto iterator = blocks.begin(); iterator != blocks.end(); ++iterator) {
+    ++blockCount;
+  }
+  size_t result = cDumpHeaderSize + mFibonacciCount * sizeof(uint64_t) + blockCount * sizeof(uint32_t);
+  if(result <= aSize) {
+    uint8_t* to = static_cast<uint8_t*>(aBuffer);
+    to = writeLittleEndian(to, cDumpMagic, sizeof(uint32_t));
+    to = writeLittleEndian(to, cDumpVersion, sizeof(uint32_t));
+    to = writeLittleEndian(to, tFibonacciIndexDifference, sizeof(uint32_t));
+    to = writeLittleEndian(to, mFibonacciCount, sizeof(uint32_t));
+    to = writeLittleEndian(to, mBlockSize, sizeof(uint64_t));
+    to = writeLittleEndian(to, cHeaderSize, sizeof(uint64_t));
+    to = writeLittleEndian(to, blockCount, sizeof(uint64_t));
+    for(size_t i = 0u; i < mFibonacciCount; ++i) {
+      to = writeLittleEndian(to, cTables.mFibonaccis[i], sizeof(uint64_t));
     }
-    else {
-      tInterface::badAlloc();
+    for(auto block : blocks) {
+      to = writeLittleEndian(to, static_cast<uint32_t>(block.mIndex) | (block.mFree ? cDumpFreeBit : 0u), sizeof(uint32_t));
     }
   }
   else { // nothing to do
   }
-  tInterface::unlock();
+  for(size_t i = mFibonacciCount - 1u; i < mFibonacciCount; --i) {
+    unlockLevel(i);
+  }
+  unlock();
+  return result;
 }
 
-template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory>
-bool FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory>::isCorrectEmpty() const noexcept {
-  tInterface::lock();
-  auto found = std::find_if(mFreeSets, mFreeSets + mFibonacciCount, [](auto &set){
-    return set.size() > 0u;
-  });
-  bool result = (found - mFreeSets == mFibonacciCount - 1u && found->size() == 1u && mFreeSpace == getUserBlockSize(mFibonacciCount - 1u));
-  tInterface::unlock();
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+template<typename tMovable>
+size_t FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::reserveSparseNode(tMovable const& aMovable, size_t const aDivisor, void** const aReserved, size_t const aCapacity, void*& aStart, void*& aEnd) noexcept {
+  SparseNode best { nullptr, 0u, 0u };
+  bool movableOnly;
+  size_t result = 0u;
+  lock();
+  for(size_t i = 0u; i < mFibonacciCount; ++i) {
+    lockLevel(i);
+  }
+  examineNode(mData, mFibonacciCount - 1u, aMovable, aDivisor, best, movableOnly);
+  uint8_t* end = (best.mStart != nullptr ? best.mStart + mBlockSize * cTables.mFibonaccis[best.mIndex] : nullptr);
+  for(uint8_t* block = best.mStart; block < end && result < aCapacity; block += mBlockSize * cTables.mFibonaccis[getHeader(block)->getIndex()]) {
+    size_t index = getHeader(block)->getIndex();
+    if(removeFreeBuddy(block, index)) {
+      decreaseFreeSpace(getUserBlockSize(index));
+      countAllocation(index, 0u);
+      aReserved[result] = block + cHeaderSize;
+      ++result;
+    }
+    else { // nothing to do
+    }
+  }
+  for(size_t i = mFibonacciCount - 1u; i < mFibonacciCount; --i) {
+    unlockLevel(i);
+  }
+  unlock();
+  aStart = best.mStart;
+  aEnd = end;
   return result;
 }
 
-template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory>
-size_t FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory>::calculateFibonaccis(size_t* const aResult, size_t const aMaxCount, size_t const aMaxValue) noexcept {
-  intptr_t index = tFibonacciIndexDifference + 1u;
-  std::iota(aResult, aResult + index, 1u);
-  size_t next = 0u;
-  while(index < aMaxCount && next < aMaxValue) {
-    next = aResult[index - 1u] + aResult[index - 1u - tFibonacciIndexDifference];
-    aResult[index] = next;
-    ++index;
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+template<typename tMovable>
+size_t FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::examineNode(uint8_t* const aNode, size_t const aIndex, tMovable const& aMovable, size_t const aDivisor, SparseNode& aBest, bool& aMovableOnly) const noexcept {
+  size_t size = mBlockSize * cTables.mFibonaccis[aIndex];
+  BlockHeader const* header = getHeader(aNode);
+  size_t used;
+  if(header->getIndex() == aIndex) { // a whole block
+    used = (header->isFree() ? 0u : size);
+    aMovableOnly = header->isFree() || aMovable(aNode + cHeaderSize);
+  }
+  else { // split, so both children start with a block
+    size_t leftIndex = aIndex - tFibonacciIndexDifference - 1u;
+    bool rightMovableOnly;
+    used = examineNode(aNode, leftIndex, aMovable, aDivisor, aBest, aMovableOnly);
+    used += examineNode(aNode + mBlockSize * cTables.mFibonaccis[leftIndex], aIndex - 1u, aMovable, aDivisor, aBest, rightMovableOnly);
+    aMovableOnly = aMovableOnly && rightMovableOnly;
+    if(aMovableOnly && used > 0u && used <= size / aDivisor && aIndex < mFibonacciCount - 1u && aIndex > getLargestFreeIndex() && size <= getFreeSpace() &&
+       (aBest.mStart == nullptr || aIndex > aBest.mIndex || (aIndex == aBest.mIndex && used < aBest.mUsed))) {
+      aBest = SparseNode { aNode, aIndex, used };
+    }
+    else { // nothing to do
+    }
   }
-  return static_cast<size_t>(index);
+  return used;
 }
 
-template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory>
-size_t FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory>::calculateTotalHeaderSize(size_t const * const aFibonaccis, size_t const aFibonacciCount) noexcept {
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+size_t FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::calculateTotalHeaderSize(size_t const aFibonacciCount) noexcept {
+  size_t freeStructureSize = tConfig::cIntrusiveFreeLists
+    ? alignof(BlockLink)        + aFibonacciCount * sizeof(BlockLink)
+    : alignof(FreeSet)          + aFibonacciCount * sizeof(FreeSet)
+    + alignof(std::max_align_t) + cTables.mFibonaccis[aFibonacciCount - 2u - tFibonacciIndexDifference] * mSetNodeSize;
+  size_t headerTableSize = tConfig::cHeaderless ? alignof(BlockHeader) + cTables.mFibonaccis[aFibonacciCount - 1u] * sizeof(BlockHeader) : 0u;
   return sizeof(*this)
-  + alignof(FreeSet)          + aFibonacciCount * sizeof(FreeSet)
-  + alignof(size_t)           + aFibonacciCount * sizeof(size_t)
-  + alignof(FibonacciCell)    + aFibonacciCount * aFibonacciCount * sizeof(FibonacciCell)
-  + alignof(std::max_align_t) + aFibonaccis[aFibonacciCount - 2u - tFibonacciIndexDifference] * mSetNodeSize
+  + freeStructureSize
+  + headerTableSize
   + tAlignment;
 }
 
-template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory>
-void FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory>::initInternalData(void* aMemory) noexcept {
-  uint8_t* allocatorLocation = static_cast<uint8_t*>(alignTo(reinterpret_cast<uint8_t*>(aMemory) + sizeof(*this), alignof(FreeSetAllocator)));
-  mFreeSets = static_cast<FreeSet*>(alignTo(reinterpret_cast<uint8_t*>(allocatorLocation) + sizeof(FreeSetAllocator), alignof(FreeSet)));
-  mFibonaccis = static_cast<size_t*>(alignTo(reinterpret_cast<uint8_t*>(mFreeSets) + mFibonacciCount * sizeof(FreeSet), alignof(size_t)));
-  calculateFibonaccis(mFibonaccis, mFibonacciCount, tMemorySize);
-  mAllocationDirections = new(alignTo(mFibonaccis + mFibonacciCount, alignof(FibonacciCell))) FibonacciCell[mFibonacciCount * mFibonacciCount];
-  fillAllocationDirections();
-  mPool = alignToMax(mAllocationDirections + mFibonacciCount * mFibonacciCount);
-  FixedOccupier occupier(mPool);
-  size_t poolSize = mFibonaccis[mFibonacciCount - 2u - tFibonacciIndexDifference];
-  mAllocator = new(allocatorLocation) FreeSetAllocator(poolSize, mSetNodeSize, occupier);
-  for(size_t i = 0; i < mFibonacciCount; ++i) {
-    new(mFreeSets + i) FreeSet(*mAllocator);
-  }
-  void* data = alignTo(reinterpret_cast<uint8_t*>(mPool) + poolSize * mSetNodeSize, tAlignment);
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::initInternalData(void* aMemory) noexcept {
+  uint8_t* structureEnd;
+  if(tConfig::cIntrusiveFreeLists) {
+    mFreeLists = static_cast<BlockLink*>(alignTo(reinterpret_cast<uint8_t*>(aMemory) + sizeof(*this), alignof(BlockLink)));
+    for(size_t i = 0; i < mFibonacciCount; ++i) {
+      new(mFreeLists + i) BlockLink(nullptr);
+    }
+    structureEnd = reinterpret_cast<uint8_t*>(mFreeLists + mFibonacciCount);
+  }
+  else {
+    uint8_t* allocatorLocation = static_cast<uint8_t*>(alignTo(reinterpret_cast<uint8_t*>(aMemory) + sizeof(*this), alignof(FreeSetAllocator)));
+    mFreeSets = static_cast<FreeSet*>(alignTo(reinterpret_cast<uint8_t*>(allocatorLocation) + sizeof(FreeSetAllocator), alignof(FreeSet)));
+    structureEnd = reinterpret_cast<uint8_t*>(mFreeSets) + mFibonacciCount * sizeof(FreeSet);
+    mAllocator = reinterpret_cast<FreeSetAllocator*>(allocatorLocation);
+  }
+  if(tConfig::cHeaderless) { // the entries are written when blocks start there, the rest must not look allocated
+    mHeaders = static_cast<BlockHeader*>(alignTo(structureEnd, alignof(BlockHeader)));
+    structureEnd = reinterpret_cast<uint8_t*>(mHeaders + cTables.mFibonaccis[mFibonacciCount - 1u]);
+    for(size_t i = 0; i < cTables.mFibonaccis[mFibonacciCount - 1u]; ++i) {
+      (mHeaders + i)->set(false, false, 0u);
+      (mHeaders + i)->setFree(true);
+    }
+  }
+  else { // nothing to do
+  }
+  void* data;
+  if(tConfig::cIntrusiveFreeLists) {
+    mPool = nullptr;
+    data = alignTo(structureEnd, tAlignment);
+  }
+  else {
+    mPool = alignToMax(structureEnd);
+    FixedOccupier occupier(mPool);
+    size_t poolSize = cTables.mFibonaccis[mFibonacciCount - 2u - tFibonacciIndexDifference];
+    mAllocator = new(mAllocator) FreeSetAllocator(poolSize, mSetNodeSize, occupier);
+    for(size_t i = 0; i < mFibonacciCount; ++i) {
+      new(mFreeSets + i) FreeSet(*mAllocator);
+    }
+    data = alignTo(reinterpret_cast<uint8_t*>(mPool) + poolSize * mSetNodeSize, tAlignment);
+  }
   mData = reinterpret_cast<uint8_t*>(data);
-  static_cast<BlockHeader*>(data)->set(false, false, mFibonacciCount - 1u);
-  mFreeSets[mFibonacciCount - 1u].insert(mData);
-  mFreeSpace = getMaxUserBlockSize();
+  getHeader(data)->set(false, false, mFibonacciCount - 1u);
+  pushFree(mData, mFibonacciCount - 1u);
+  mFreeSpace.store(getMaxUserBlockSize(), std::memory_order_relaxed);
+  mSignature = getImageSignature();
   mReady = true;
 }
 
-template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory>
-void FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory>::fillAllocationDirections() noexcept {
-  for(size_t i = 0u; i < mFibonacciCount; ++i) {
-    allocationDirectionAt(i, i).set(true);
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+size_t FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::findFree(size_t const aFrom, size_t const * const aMask) const noexcept {
+  size_t result = mFibonacciCount;
+  if(aFrom < mFibonacciCount) {
+    size_t word = aFrom / cBitsPerWord;
+    size_t bits = mOccupied[word].load(std::memory_order_relaxed) & (~static_cast<size_t>(0u) << (aFrom % cBitsPerWord));
+    while(true) {
+      if(aMask != nullptr) {
+        bits &= aMask[word];
+      }
+      else { // nothing to do
+      }
+      if(bits != 0u) {
+        result = word * cBitsPerWord + countTrailingZeros(bits);
+        break;
+      }
+      else if(++word < cBitmapWords) {
+        bits = mOccupied[word].load(std::memory_order_relaxed);
+      }
+      else {
+        break;
+      }
+    }
+  }
+  else { // nothing to do
   }
-  for(size_t i = 1u; i <= tFibonacciIndexDifference; ++i) {
-    for(size_t j = 0u; j < i; ++j) {
-      allocationDirectionAt(i, j).set(false);
+  return result;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+uint8_t* FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::takeFree(size_t const aFrom, size_t const * const aMask, size_t& aIndex) noexcept {
+  uint8_t* block = nullptr;
+  size_t index = findFree(aFrom, aMask);
+  while(index < mFibonacciCount && block == nullptr) {
+    lockLevel(index);
+    if(hasFree(index)) {
+      block = popFree(index);
+    }
+    else { // nothing to do
+    }
+    unlockLevel(index);
+    if(block == nullptr) {
+      index = findFree(index + 1u, aMask);
+    }
+    else { // nothing to do
     }
   }
-  if(mExactAllocation) {
-    for(size_t i = tFibonacciIndexDifference + 1u; i < mFibonacciCount; ++i) {
-      for(size_t j = 0u; j < i; ++j) {
-        auto& leftChild = allocationDirectionAt(i - tFibonacciIndexDifference - 1u, j);
-        auto& rightChild = allocationDirectionAt(i - 1u, j);
-        if(j <= i - tFibonacciIndexDifference - 1u && leftChild.isExact()) {
-          allocationDirectionAt(i, j).set(true, FibonacciDirection::cLeft);
-        }
-        else if(rightChild.isExact()) {
-          allocationDirectionAt(i, j).set(true, FibonacciDirection::cRight);
-        }
-        else if(j <= i - tFibonacciIndexDifference - 1u) {
-          allocationDirectionAt(i, j).set(false, FibonacciDirection::cLeft);
-        }
-        else {
-          allocationDirectionAt(i, j).set(false, FibonacciDirection::cRight);
-        }
-      }
+  aIndex = index;
+  return block;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+uint8_t* FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::popFree(size_t const aIndex) noexcept {
+  uint8_t* block;
+  bool preferCommitted = cDecommitEnabled && aIndex >= tConfig::cDecommitIndex;
+  if(tConfig::cIntrusiveFreeLists) {
+    block = mFreeLists[aIndex];
+    uint8_t* candidate = block;
+    for(size_t scanned = 0u; preferCommitted && candidate != nullptr && scanned < cDecommitScanLength && getHeader(candidate)->isDecommitted(); ++scanned) {
+      candidate = getLinks(candidate)->mNext;
     }
+    if(preferCommitted && candidate != nullptr && !getHeader(candidate)->isDecommitted()) {
+      block = candidate;
+    }
+    else { // nothing to do
+    }
+    unlinkFree(block, aIndex);
   }
   else {
-    for(size_t i = tFibonacciIndexDifference + 1u; i < mFibonacciCount; ++i) {
-      for(size_t j = 0u; j < i; ++j) {
-        if(j <= i - tFibonacciIndexDifference - 1u) {
-          bool leftExact = allocationDirectionAt(i - tFibonacciIndexDifference - 1u, j).isExact();
-          allocationDirectionAt(i, j).set(leftExact, FibonacciDirection::cLeft);
-        }
-        else {
-          bool rightExact = allocationDirectionAt(i - 1u, j).isExact();
-          allocationDirectionAt(i, j).set(rightExact, FibonacciDirection::cRight);
-        }
+    auto chosen = preferCommitted ? mFreeSets[aIndex].end() : findRecent(aIndex, std::integral_constant<bool, cReuseEnabled>());
+    if(chosen == mFreeSets[aIndex].end()) {
+      chosen = mFreeSets[aIndex].begin();
+    }
+    else { // nothing to do
+    }
+    auto candidate = chosen;
+    for(size_t scanned = 0u; preferCommitted && candidate != mFreeSets[aIndex].end() && scanned < cDecommitScanLength && getHeader(*candidate)->isDecommitted(); ++scanned) {
+      ++candidate;
+    }
+    if(preferCommitted && candidate != mFreeSets[aIndex].end() && !getHeader(*candidate)->isDecommitted()) {
+      chosen = candidate;
+    }
+    else { // nothing to do
+    }
+    block = *chosen;
+    mFreeSets[aIndex].erase(chosen);
+  }
+  getHeader(block)->setFree(false);
+  setOccupied(aIndex, tConfig::cIntrusiveFreeLists ? mFreeLists[aIndex] != nullptr : mFreeSets[aIndex].size() > 0u);
+  return block;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+typename FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::FreeSet::iterator FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::findRecent(size_t const aIndex, std::true_type) noexcept {
+  FreeSet& freeSet = mFreeSets[aIndex];
+  auto result = freeSet.end();
+  while(result == freeSet.end() && mRecentCounts[aIndex] > 0u) {
+    uint8_t* recent = mRecent[aIndex][mRecentTops[aIndex]];
+    bool used = true;
+    if(tConfig::cReuse == FibonacciReuse::cLastFreed) {
+      result = freeSet.find(recent);
+    }
+    else {
+      uint8_t* page = reinterpret_cast<uint8_t*>(reinterpret_cast<uintptr_t>(recent) & ~static_cast<uintptr_t>(tConfig::cPageSize - 1u));
+      auto candidate = freeSet.lower_bound(page);
+      if(candidate != freeSet.end() && *candidate < page + tConfig::cPageSize) {
+        result = candidate;
+        used = *candidate == recent; // keep it while other blocks may be free in the page
+      }
+      else { // nothing to do
       }
     }
+    if(used) {
+      mRecentTops[aIndex] = (mRecentTops[aIndex] + cRecentDepth - 1u) % cRecentDepth;
+      --mRecentCounts[aIndex];
+    }
+    else { // nothing to do
+    }
+  }
+  return result;
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::pushFree(uint8_t* const aBlock, size_t const aIndex) noexcept {
+  if(tConfig::cIntrusiveFreeLists) {
+    FreeLinks* links = getLinks(aBlock);
+    uint8_t* next = mFreeLists[aIndex];
+    links->mPrevious = nullptr;
+    links->mNext = next;
+    if(next != nullptr) {
+      getLinks(next)->mPrevious = aBlock;
+    }
+    else { // nothing to do
+    }
+    mFreeLists[aIndex] = aBlock;
+  }
+  else {
+    mFreeSets[aIndex].insert(aBlock);
   }
+  getHeader(aBlock)->setFree(true);
+  setOccupied(aIndex, true);
 }
 
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+void FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::unlinkFree(uint8_t* const aBlock, size_t const aIndex) noexcept {
+  FreeLinks* links = getLinks(aBlock);
+  if(links->mPrevious != nullptr) {
+    getLinks(links->mPrevious)->mNext = links->mNext;
+  }
+  else {
+    mFreeLists[aIndex] = links->mNext;
+  }
+  if(links->mNext != nullptr) {
+    getLinks(links->mNext)->mPrevious = links->mPrevious;
+  }
+  else { // nothing to do
+  }
+}
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, uintptr_t tMemory, typename tConfig>
+bool FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tMemory, tConfig>::removeFreeBuddy(uint8_t* const aBlock, size_t const aIndex) noexcept {
+  BlockHeader* header = getHeader(aBlock);
+  bool result = header->isFree() && header->getIndex() == aIndex;
+  if(result) {
+    if(tConfig::cIntrusiveFreeLists) {
+      unlinkFree(aBlock, aIndex);
+    }
+    else {
+      mFreeSets[aIndex].erase(aBlock);
+    }
+    header->setFree(false);
+    setOccupied(aIndex, tConfig::cIntrusiveFreeLists ? mFreeLists[aIndex] != nullptr : mFreeSets[aIndex].size() > 0u);
+  }
+  else { // nothing to do
+  }
+  return result;
+}
 
 } }
 
@@ -0,0 +1,199 @@
+#ifndef NOWTECH_FIBONACCISHAREDMEMORY
+#define NOWTECH_FIBONACCISHAREDMEMORY
+
+#include "FibonacciMemoryManager.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace nowtech { namespace memory {
+
+/// A POSIX process-shared robust mutex usable as FibonacciConfig::InstanceLock. If a process dies while
+/// holding it, the next one locking it takes it over instead of waiting forever. The heap may have been
+/// left half modified then, which getRecoveryCount() lets the application notice.
+class RobustMutex final {
+private:
+  pthread_mutex_t       mMutex;
+  std::atomic<uint32_t> mRecoveryCount { 0u };
+
+public:
+  RobustMutex() noexcept {
+    pthread_mutexattr_t attributes;
+    pthread_mutexattr_init(&attributes);
+    pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&mMutex, &attributes);
+    pthread_mutexattr_destroy(&attributes);
+  }
+
+  RobustMutex(RobustMutex const&) = delete;
+  RobustMutex& operator=(RobustMutex const&) = delete;
+
+  void lock() noexcept {
+    recover(pthread_mutex_lock(&mMutex));
+  }
+
+  bool try_lock() noexcept {
+    return recover(pthread_mutex_trylock(&mMutex)) == 0;
+  }
+
+  void unlock() noexcept {
+    pthread_mutex_unlock(&mMutex);
+  }
+
+  /// @returns how many times the mutex was taken over from a dead owner.
+  uint32_t getRecoveryCount() const noexcept {
+    return mRecoveryCount.load(std::memory_order_relaxed);
+  }
+
+private:
+  int recover(int const aResult) noexcept {
+    int result = aResult;
+    if(result == EOWNERDEAD) {
+      pthread_mutex_consistent(&mMutex);
+      mRecoveryCount.fetch_add(1u, std::memory_order_relaxed);
+      result = 0;
+    }
+    else { // nothing to do
+    }
+    return result;
+  }
+};
+
+/// Maps a FibonacciMemoryManager in a POSIX shared memory object named aName. The first process creates and
+/// builds it, the others attach to it, and all of them may allocate and deallocate concurrently. Each process
+/// has the heap at its own address, so pointers are passed to other processes as offsets from getBase().
+/// The configuration needs cIntrusiveFreeLists, cPositionIndependent and a locking mode with a process-shared
+/// InstanceLock, like RobustMutex. The default SpinLock works too, but waits forever for a dead owner.
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, typename tConfig>
+class FibonacciSharedMemory final {
+  static_assert(tConfig::cPositionIndependent, "Each process maps the shared heap at its own address.");
+  static_assert(tConfig::cLocking != FibonacciLocking::cInterface, "The interface lock can't exclude other processes.");
+
+public:
+  typedef FibonacciMemoryManager<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, 0u, tConfig> Manager;
+
+private:
+  /// Placed before the manager, so the openers can wait until the creator has built it.
+  class State final {
+  public:
+    std::atomic<uint32_t> mReady;
+  };
+
+  static constexpr size_t   cStateSize    = (sizeof(State) + alignof(std::max_align_t) - 1u) / alignof(std::max_align_t) * alignof(std::max_align_t);
+  static constexpr size_t   cMappingSize  = cStateSize + tMemorySize;
+  static constexpr uint32_t cReady        = 1u;
+  static constexpr size_t   cWaitCount    = 5000u; // for the creator, 1 ms each
+
+  uint8_t* mMapping = nullptr;
+  Manager* mManager = nullptr;
+  bool     mCreator = false;
+
+public:
+  /// Opens the shared memory object or creates it if it does not exist yet.
+  /// Calls tInterface::badAlloc() on failure, and getManager() returns nullptr then.
+  FibonacciSharedMemory(char const * const aName, bool const aExactAllocation);
+
+  FibonacciSharedMemory(FibonacciSharedMemory const&) = delete;
+  FibonacciSharedMemory& operator=(FibonacciSharedMemory const&) = delete;
+
+  /// Unmaps the heap, but the shared memory object stays until remove() and the last unmapping.
+  ~FibonacciSharedMemory() noexcept {
+    if(mMapping != nullptr) {
+      munmap(mMapping, cMappingSize);
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// Removes the name, so later constructors create a new heap. The processes having it mapped may go on.
+  static bool remove(char const * const aName) noexcept {
+    return shm_unlink(aName) == 0;
+  }
+
+  Manager* getManager() const noexcept {
+    return mManager;
+  }
+
+  bool isCreator() const noexcept {
+    return mCreator;
+  }
+
+  /// @returns the start of the mapping in this process, offsets passed between processes are relative to it.
+  uint8_t* getBase() const noexcept {
+    return mMapping;
+  }
+
+  size_t toOffset(void const * const aPointer) const noexcept {
+    return static_cast<size_t>(static_cast<uint8_t const*>(aPointer) - mMapping);
+  }
+
+  void* toPointer(size_t const aOffset) const noexcept {
+    return mMapping + aOffset;
+  }
+
+private:
+  /// @returns true if aCondition became true in cWaitCount ms.
+  template<typename tCondition>
+  static bool waitFor(tCondition aCondition) noexcept {
+    size_t waited = 0u;
+    while(!aCondition() && waited < cWaitCount) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      ++waited;
+    }
+    return aCondition();
+  }
+};
+
+template <typename tInterface, size_t tMemorySize, size_t tMinimalBlockSize, size_t tAlignment, size_t tFibonacciIndexDifference, typename tConfig>
+FibonacciSharedMemory<tInterface, tMemorySize, tMinimalBlockSize, tAlignment, tFibonacciIndexDifference, tConfig>::FibonacciSharedMemory(char const * const aName, bool const aExactAllocation) {
+  int file = shm_open(aName, O_RDWR | O_CREAT | O_EXCL, 0600);
+  mCreator = (file >= 0);
+  if(!mCreator && errno == EEXIST) {
+    file = shm_open(aName, O_RDWR, 0600);
+  }
+  else { // nothing to do
+  }
+  bool sized = false;
+  if(mCreator) {
+    sized = (ftruncate(file, static_cast<off_t>(cMappingSize)) == 0);
+  }
+  else if(file >= 0) {
+    sized = waitFor([file]() {
+      struct stat status;
+      return fstat(file, &status) == 0 && static_cast<size_t>(status.st_size) >= cMappingSize;
+    });
+  }
+  else { // nothing to do
+  }
+  if(sized) {
+    void* mapping = mmap(nullptr, cMappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    mMapping = (mapping != MAP_FAILED ? static_cast<uint8_t*>(mapping) : nullptr);
+  }
+  else { // nothing to do
+  }
+  if(file >= 0) {
+    close(file);
+  }
+  else { // nothing to do
+  }
+  State* state = reinterpret_cast<State*>(mMapping);
+  void* memory = (mMapping != nullptr ? mMapping + cStateSize : nullptr);
+  if(mMapping != nullptr && mCreator) {
+    mManager = new(memory) Manager(memory, aExactAllocation);
+    state->mReady.store(cReady, std::memory_order_release);
+  }
+  else if(mMapping != nullptr && waitFor([state]() { return state->mReady.load(std::memory_order_acquire) == cReady; })) {
+    mManager = Manager::attach(memory, true); // calls badAlloc itself on failure
+  }
+  else {
+    tInterface::badAlloc();
+  }
+}
+
+} }
+
+#endif
@@ -7,6 +7,15 @@
 #include <random>
 #include <chrono>
 #include <stdexcept>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <fstream>
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 using namespace nowtech::memory;
 
@@ -24,6 +33,78 @@ public:
   }
 };
 
+class LockingInterface final {
+public:
+  static std::mutex sMutex;
+
+  static void badAlloc() {
+    throw std::bad_alloc();
+  }
+
+  static void lock() {
+    sMutex.lock();
+  }
+
+  static void unlock() {
+    sMutex.unlock();
+  }
+};
+
+std::mutex LockingInterface::sMutex;
+
+class DecommitInterface final {
+public:
+  static size_t sDecommitted;
+
+  static void badAlloc() {
+    throw std::bad_alloc();
+  }
+
+  static void lock() {
+  }
+
+  static void unlock() {
+  }
+
+  static void decommit(void* const aStart, size_t const aLength) noexcept {
+#if defined(__linux__)
+    madvise(aStart, aLength, MADV_DONTNEED);
+#endif
+    sDecommitted += aLength;
+  }
+};
+
+size_t DecommitInterface::sDecommitted = 0u;
+
+class GrowthInterface final {
+public:
+  static size_t sGrown;
+  static size_t sReleased;
+
+  static void badAlloc() {
+    throw std::bad_alloc();
+  }
+
+  static void lock() {
+  }
+
+  static void unlock() {
+  }
+
+  static void* grow(size_t const aSize) {
+    ++sGrown;
+    return new uint8_t[aSize];
+  }
+
+  static void release(void* const aMemory, size_t const) {
+    ++sReleased;
+    delete[] static_cast<uint8_t*>(aMemory);
+  }
+};
+
+size_t GrowthInterface::sGrown = 0u;
+size_t GrowthInterface::sReleased = 0u;
+
 char cSeparator[] = "\n----------------------------------------------------\n\n";
 constexpr size_t cMemorySize           = 1024u * 32768u;
 constexpr size_t cMinBlockSize         =     128u;
@@ -33,6 +114,9 @@ constexpr size_t cDiverseAllocCount    =   11111u;
 constexpr size_t cPoolSize             =     111u;
 constexpr size_t cBenchmarkAllocSize   =    1111u;
 constexpr size_t cBenchmarkAllocCount  =   10000u;
+constexpr size_t cThreadCount          =       4u;
+constexpr size_t cThreadAllocCount     =  200000u;
+constexpr size_t cThreadSmallSize      =     100u;
 
 typedef FibonacciMemoryManager<Interface, cMemorySize, cMinBlockSize, cUserAlign, cFibonacciDifference> Fibonacci;
 
@@ -132,6 +216,164 @@ void testDiverse(size_t const aAllocCount, bool const aExact) noexcept {
 
 typedef NewDelete<Interface, cMemorySize, cMinBlockSize, cUserAlign, cFibonacciDifference> ExampleNewDelete;
 
+struct IntrusiveConfig : public FibonacciConfig {
+  static constexpr bool cIntrusiveFreeLists = true;
+};
+
+typedef NewDelete<Interface, cMemorySize, cMinBlockSize, cUserAlign, cFibonacciDifference, 0u, IntrusiveConfig> IntrusiveNewDelete;
+typedef FibonacciMemoryManager<Interface, cMemorySize, cMinBlockSize, cUserAlign, cFibonacciDifference, 0u, IntrusiveConfig> IntrusiveFibonacci;
+
+struct ThreadCacheConfig : public IntrusiveConfig {
+  static constexpr size_t cThreadCacheDepth = 32u;
+};
+
+typedef NewDelete<LockingInterface, cMemorySize, cMinBlockSize, cUserAlign, cFibonacciDifference, 0u, IntrusiveConfig> LockingNewDelete;
+typedef NewDelete<LockingInterface, cMemorySize, cMinBlockSize, cUserAlign, cFibonacciDifference, 0u, ThreadCacheConfig> CachedNewDelete;
+struct RemoteFreeConfig : public IntrusiveConfig {
+  static constexpr FibonacciLocking cLocking = FibonacciLocking::cInstance;
+  static constexpr bool cRemoteFree = true;
+};
+
+typedef NewDelete<Interface, cMemorySize, cMinBlockSize, cUserAlign, cFibonacciDifference, 0u, RemoteFreeConfig> RemoteFreeNewDelete;
+
+struct InstanceConfig : public IntrusiveConfig {
+  static constexpr FibonacciLocking cLocking = FibonacciLocking::cInstance;
+};
+
+typedef NewDelete<Interface, cMemorySize, cMinBlockSize, cUserAlign, cFibonacciDifference, 0u, InstanceConfig> InstanceNewDelete;
+
+struct PerIndexConfig : public IntrusiveConfig {
+  static constexpr FibonacciLocking cLocking = FibonacciLocking::cPerIndex;
+};
+
+typedef NewDelete<LockingInterface, cMemorySize, cMinBlockSize, cUserAlign, cFibonacciDifference, 0u, PerIndexConfig> PerIndexNewDelete;
+
+struct LazyConfig : public IntrusiveConfig {
+  static constexpr bool cLazyCoalescing = true;
+};
+
+typedef NewDelete<Interface, cMemorySize, cMinBlockSize, cUserAlign, cFibonacciDifference, 0u, LazyConfig> LazyNewDelete;
+
+struct PowerOfTwoConfig : public IntrusiveConfig {
+  static constexpr bool cPowerOfTwoBlockSize = true;
+};
+
+typedef NewDelete<Interface, cMemorySize, cMinBlockSize, cUserAlign, cFibonacciDifference, 0u, PowerOfTwoConfig> PowerOfTwoNewDelete;
+
+struct DecommitConfig : public FibonacciConfig {
+  static constexpr size_t cDecommitIndex = 16u; // about 32 kB
+};
+
+typedef FibonacciMemoryManager<DecommitInterface, cMemorySize, cMinBlockSize, cUserAlign, cFibonacciDifference, 0u, DecommitConfig> DecommitFibonacci;
+
+struct StatisticsConfig : public IntrusiveConfig {
+  static constexpr bool cStatistics = true;
+};
+
+typedef NewDelete<LockingInterface, cMemorySize, cMinBlockSize, cUserAlign, cFibonacciDifference, 0u, StatisticsConfig> StatisticsNewDelete;
+typedef ShardedNewDelete<LockingInterface, cMemorySize, cMinBlockSize, cUserAlign, cFibonacciDifference, cThreadCount, 0u, StatisticsConfig> ShardedStatisticsNewDelete;
+typedef ShardedNewDelete<LockingInterface, cMemorySize, cMinBlockSize, cUserAlign, cFibonacciDifference, cThreadCount, 0u, IntrusiveConfig> ExampleShardedNewDelete;
+
+struct GrowthConfig : public IntrusiveConfig {
+  static constexpr size_t cGrowthRegionCount = 3u;
+};
+
+typedef NewDelete<GrowthInterface, cMemorySize / 32u, cMinBlockSize, cUserAlign, cFibonacciDifference, 0u, GrowthConfig> GrowingNewDelete;
+
+struct SlabConfig : public IntrusiveConfig {
+  static constexpr size_t cSlabClassCount = 8u; // up to 64 bytes
+};
+
+typedef NewDelete<Interface, cMemorySize, cMinBlockSize, cUserAlign, cFibonacciDifference, 0u, SlabConfig> SlabNewDelete;
+typedef FibonacciMemoryManager<Interface, cMemorySize, cMinBlockSize, cUserAlign, cFibonacciDifference, 0u, SlabConfig> SlabFibonacci;
+
+struct PersistentConfig : public SlabConfig {
+  static constexpr bool cPositionIndependent = true;
+};
+
+typedef NewDelete<Interface, cMemorySize / 32u, cMinBlockSize, cUserAlign, cFibonacciDifference, 0u, PersistentConfig> PersistentNewDelete;
+
+struct LastFreedConfig : public FibonacciConfig {
+  static constexpr FibonacciReuse cReuse = FibonacciReuse::cLastFreed;
+};
+
+typedef NewDelete<Interface, cMemorySize, cMinBlockSize, cUserAlign, cFibonacciDifference, 0u, LastFreedConfig> LastFreedNewDelete;
+
+struct SamePageConfig : public FibonacciConfig {
+  static constexpr FibonacciReuse cReuse = FibonacciReuse::cSamePage;
+};
+
+typedef NewDelete<Interface, cMemorySize, cMinBlockSize, cUserAlign, cFibonacciDifference, 0u, SamePageConfig> SamePageNewDelete;
+
+struct HandleConfig : public FibonacciConfig {
+  static constexpr size_t cHandleCount = 32768u;
+};
+
+typedef NewDelete<Interface, cMemorySize, cMinBlockSize, cUserAlign, cFibonacciDifference, 0u, HandleConfig> HandleNewDelete;
+
+struct IntrusiveHandleConfig : public IntrusiveConfig {
+  static constexpr size_t cHandleCount = 32768u;
+};
+
+typedef NewDelete<Interface, cMemorySize, cMinBlockSize, cUserAlign, cFibonacciDifference, 0u, IntrusiveHandleConfig> IntrusiveHandleNewDelete;
+
+struct HeaderlessConfig : public IntrusiveConfig {
+  static constexpr bool cHeaderless = true;
+};
+
+typedef NewDelete<Interface, cMemorySize, cMinBlockSize, cUserAlign, cFibonacciDifference, 0u, HeaderlessConfig> HeaderlessNewDelete;
+typedef FibonacciMemoryManager<Interface, cMemorySize, cMinBlockSize, cUserAlign, cFibonacciDifference, 0u, HeaderlessConfig> HeaderlessFibonacci;
+
+struct HeaderlessSlabConfig : public HeaderlessConfig {
+  static constexpr size_t cSlabClassCount = 8u;
+};
+
+typedef FibonacciMemoryManager<Interface, cMemorySize, cMinBlockSize, cUserAlign, cFibonacciDifference, 0u, HeaderlessSlabConfig> HeaderlessSlabFibonacci;
+
+class BusyLock final { // try_lock fails while sBusy, so deallocation takes the remote free path
+public:
+  static bool sBusy;
+
+  void lock() noexcept {
+    mLock.lock();
+  }
+
+  bool try_lock() noexcept {
+    return !sBusy && mLock.try_lock();
+  }
+
+  void unlock() noexcept {
+    mLock.unlock();
+  }
+
+private:
+  SpinLock mLock;
+};
+
+bool BusyLock::sBusy = false;
+
+struct BusyRemoteFreeConfig : public HeaderlessConfig {
+  static constexpr FibonacciLocking cLocking = FibonacciLocking::cInstance;
+  static constexpr bool cRemoteFree = true;
+  typedef BusyLock InstanceLock;
+};
+
+typedef FibonacciMemoryManager<Interface, cMemorySize, cMinBlockSize, cUserAlign, cFibonacciDifference, 0u, BusyRemoteFreeConfig> BusyRemoteFreeFibonacci;
+
+struct BusySlabConfig : public SlabConfig {
+  static constexpr FibonacciLocking cLocking = FibonacciLocking::cInstance;
+  static constexpr bool cRemoteFree = true;
+  typedef BusyLock InstanceLock;
+};
+
+typedef FibonacciMemoryManager<Interface, cMemorySize, cMinBlockSize, cUserAlign, cFibonacciDifference, 0u, BusySlabConfig> BusySlabFibonacci;
+
+typedef FibonacciRegion<cMemorySize / 32u> FastRegion; // like a tightly coupled memory
+typedef FibonacciRegion<cMemorySize / 2u>  LargeRegion;
+typedef FibonacciRegion<cMemorySize / 8u>  MiddleRegion;
+typedef RegionNewDelete<Interface, cMinBlockSize, cUserAlign, cFibonacciDifference, FibonacciPlacement::cFirstFit, IntrusiveConfig, FastRegion, LargeRegion, MiddleRegion> FirstFitRegionNewDelete;
+typedef RegionNewDelete<Interface, cMinBlockSize, cUserAlign, cFibonacciDifference, FibonacciPlacement::cSmallestFit, LazyConfig, FastRegion, LargeRegion, MiddleRegion> SmallestFitRegionNewDelete;
+
 class Test final {
   int    mI = 0u;
   double mD = 0.0;
@@ -243,17 +485,18 @@ void testNewDelete(bool const aExact) {
   delete[] mem;
 }
 
-void benchmarkNewDelete(bool const aExact) {
+template<typename tNewDelete>
+void benchmarkNewDelete(char const * const aName, bool const aExact) {
   uint8_t* mem = new uint8_t[cMemorySize];
 
-  std::cout << "Testing NewDelete with exact = " << aExact << '\n';
+  std::cout << "Benchmarking " << aName << " with exact = " << aExact << '\n';
 
-  ExampleNewDelete::init(reinterpret_cast<void*>(mem), aExact);
+  tNewDelete::init(reinterpret_cast<void*>(mem), aExact);
    
-  std::cout << " getFreeSpace() " << ExampleNewDelete::getFreeSpace() << 
-               " getMaxUserBlockSize() " << ExampleNewDelete::getMaxUserBlockSize() <<
-               " getMaxFreeUserBlockSize() " << ExampleNewDelete::getMaxFreeUserBlockSize() <<
-               " getAlignment() " << ExampleNewDelete::getAlignment() <<
+  std::cout << " getFreeSpace() " << tNewDelete::getFreeSpace() << 
+               " getMaxUserBlockSize() " << tNewDelete::getMaxUserBlockSize() <<
+               " getMaxFreeUserBlockSize() " << tNewDelete::getMaxFreeUserBlockSize() <<
+               " getAlignment() " << tNewDelete::getAlignment() <<
                "\nChecking if everything freed.\n"; 
 
   std::uintptr_t sum = 0;
@@ -273,19 +516,151 @@ void benchmarkNewDelete(bool const aExact) {
 
   begin = std::chrono::high_resolution_clock::now();
   for(size_t i = 0u; i < cBenchmarkAllocCount; ++i) {
-    uint8_t* allocated = ExampleNewDelete::_newArray<uint8_t>(cBenchmarkAllocSize);
+    uint8_t* allocated = tNewDelete::template _newArray<uint8_t>(cBenchmarkAllocSize);
     array[i] = allocated;
     sum += reinterpret_cast<std::uintptr_t>(allocated);
   }
   for(size_t i = 0u; i < cBenchmarkAllocCount; ++i) {
-    ExampleNewDelete::_deleteArray(array[i]);
+    tNewDelete::_deleteArray(array[i]);
   }
   end = std::chrono::high_resolution_clock::now();
   timeSpan = std::chrono::duration_cast<std::chrono::duration<double>>(end - begin);
-  std::cout << cBenchmarkAllocCount << " times allocating " << cBenchmarkAllocSize << " bytes using NewDelete took " << timeSpan.count() << '\n';
+  std::cout << cBenchmarkAllocCount << " times allocating " << cBenchmarkAllocSize << " bytes using " << aName << " took " << timeSpan.count() << '\n';
   std::cout << sum << '\n';
 
-  if(!ExampleNewDelete::isCorrectEmpty()) {
+  if(!tNewDelete::isCorrectEmpty()) {
+    std::cout << "########## !!!!!!!!!!!!!!!!! corrupt after freeing everything !!!!!!!!!!!!!!!!!!\n";
+  }
+  else {  // nothing to do
+  }
+  std::cout << cSeparator;
+  delete[] mem;
+}
+
+struct Message final {
+  uint8_t mBuffer[200u];
+};
+
+template<typename tNewDelete>
+void benchmarkBulk(char const * const aName, bool const aExact) {
+  uint8_t* mem = new uint8_t[cMemorySize];
+  tNewDelete::init(reinterpret_cast<void*>(mem), aExact);
+  std::cout << "Benchmarking bulk " << aName << " with exact = " << aExact << '\n';
+
+  std::array<Message*, cBenchmarkAllocCount> array;
+  auto begin = std::chrono::high_resolution_clock::now();
+  for(size_t i = 0u; i < cBenchmarkAllocCount; ++i) {
+    array[i] = tNewDelete::template _new<Message>();
+  }
+  for(size_t i = 0u; i < cBenchmarkAllocCount; ++i) {
+    tNewDelete::_delete(array[i]);
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  auto timeSpan = std::chrono::duration_cast<std::chrono::duration<double>>(end - begin);
+  std::cout << cBenchmarkAllocCount << " times allocating " << sizeof(Message) << " bytes one by one took " << timeSpan.count() << '\n';
+
+  begin = std::chrono::high_resolution_clock::now();
+  size_t count = tNewDelete::_newBulk(cBenchmarkAllocCount, array.data());
+  tNewDelete::_deleteBulk(array.data(), count);
+  end = std::chrono::high_resolution_clock::now();
+  timeSpan = std::chrono::duration_cast<std::chrono::duration<double>>(end - begin);
+  std::cout << count << " times allocating " << sizeof(Message) << " bytes in bulk took " << timeSpan.count() << '\n';
+
+  if(count != cBenchmarkAllocCount || !tNewDelete::isCorrectEmpty()) {
+    std::cout << "########## !!!!!!!!!!!!!!!!! corrupt after freeing everything !!!!!!!!!!!!!!!!!!\n";
+  }
+  else {  // nothing to do
+  }
+  std::cout << cSeparator;
+  delete[] mem;
+}
+
+/// If aSizePerThread, each thread uses blocks of a different size class.
+template<typename tNewDelete>
+void benchmarkThreads(char const * const aName, bool const aSizePerThread = false) {
+  uint8_t* mem = new uint8_t[cMemorySize];
+  tNewDelete::init(reinterpret_cast<void*>(mem), false);
+  std::atomic<bool> corrupt(false);
+  auto begin = std::chrono::high_resolution_clock::now();
+  std::vector<std::thread> threads;
+  for(size_t t = 0u; t < cThreadCount; ++t) {
+    threads.emplace_back([t, aSizePerThread, &corrupt](){
+      size_t shift = aSizePerThread ? t * 2u : 0u;
+      std::array<uint8_t*, 16u> live;
+      for(size_t i = 0u; i < cThreadAllocCount; ++i) {
+        size_t slot = i % live.size();
+        if(i >= live.size()) {
+          if(live[slot][0] != static_cast<uint8_t>(t) || live[slot][cThreadSmallSize - 1u] != static_cast<uint8_t>(t)) {
+            corrupt = true;
+          }
+          else { // nothing to do
+          }
+          tNewDelete::_deleteArray(live[slot]);
+        }
+        else { // nothing to do
+        }
+        live[slot] = tNewDelete::template _newArray<uint8_t>((cThreadSmallSize + slot) << shift);
+        live[slot][0] = live[slot][cThreadSmallSize - 1u] = static_cast<uint8_t>(t);
+      }
+      for(auto pointer : live) {
+        tNewDelete::_deleteArray(pointer);
+      }
+    });
+  }
+  for(auto &thread : threads) {
+    thread.join();
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  auto timeSpan = std::chrono::duration_cast<std::chrono::duration<double>>(end - begin);
+  std::cout << cThreadCount << " threads " << cThreadAllocCount << " times allocating ~" << cThreadSmallSize << (aSizePerThread ? " bytes shifted by thread" : " bytes") << " using " << aName << " took " << timeSpan.count() << '\n';
+  if(corrupt || !tNewDelete::isCorrectEmpty()) {
+    std::cout << "########## !!!!!!!!!!!!!!!!! corrupt after freeing everything !!!!!!!!!!!!!!!!!!\n";
+  }
+  else {  // nothing to do
+  }
+  std::cout << cSeparator;
+  delete[] mem;
+}
+
+/// One thread allocates messages and hands them over to an other one freeing them.
+template<typename tNewDelete>
+void benchmarkProducerConsumer(char const * const aName) {
+  uint8_t* mem = new uint8_t[cMemorySize];
+  tNewDelete::init(reinterpret_cast<void*>(mem), false);
+  constexpr size_t cRingSize = 256u;
+  std::array<std::atomic<Message*>, cRingSize> ring;
+  for(auto& slot : ring) {
+    slot.store(nullptr, std::memory_order_relaxed);
+  }
+  std::atomic<bool> corrupt(false);
+  auto begin = std::chrono::high_resolution_clock::now();
+  std::thread consumer([&ring, &corrupt](){
+    for(size_t i = 0u; i < cThreadAllocCount; ++i) {
+      Message* message = nullptr;
+      while((message = ring[i % cRingSize].exchange(nullptr, std::memory_order_acquire)) == nullptr) {
+        std::this_thread::yield();
+      }
+      if(message->mBuffer[0u] != static_cast<uint8_t>(i)) {
+        corrupt = true;
+      }
+      else { // nothing to do
+      }
+      tNewDelete::_delete(message);
+    }
+  });
+  for(size_t i = 0u; i < cThreadAllocCount; ++i) {
+    Message* message = tNewDelete::template _new<Message>();
+    message->mBuffer[0u] = static_cast<uint8_t>(i);
+    while(ring[i % cRingSize].load(std::memory_order_relaxed) != nullptr) {
+      std::this_thread::yield();
+    }
+    ring[i % cRingSize].store(message, std::memory_order_release);
+  }
+  consumer.join();
+  auto end = std::chrono::high_resolution_clock::now();
+  auto timeSpan = std::chrono::duration_cast<std::chrono::duration<double>>(end - begin);
+  std::cout << cThreadAllocCount << " messages passed from a producer to a consumer using " << aName << " took " << timeSpan.count() << '\n';
+  if(corrupt || !tNewDelete::isCorrectEmpty()) {
     std::cout << "########## !!!!!!!!!!!!!!!!! corrupt after freeing everything !!!!!!!!!!!!!!!!!!\n";
   }
   else {  // nothing to do
@@ -323,6 +698,1209 @@ void testTooLargeRequest() {
   delete[] mem;
 }
 
+template<typename tFibonacci>
+void testDoubleFree(char const * const aName, bool const aExact) {
+  uint8_t* mem = new uint8_t[cMemorySize];
+  tFibonacci* fibonacci = new(mem) tFibonacci(mem, aExact);
+  std::cout << "Testing double frees using " << aName << " with exact = " << aExact << '\n';
+  constexpr size_t cCount = 8u;
+  void* pointers[cCount];
+  for(size_t i = 0u; i < cCount; ++i) {
+    pointers[i] = fibonacci->allocate(1000u);
+  }
+  size_t rejected = 0u;
+  for(size_t i = 0u; i < cCount; ++i) { // the right ones merge with their buddy freed before
+    fibonacci->deallocate(pointers[i]);
+    try {
+      fibonacci->deallocate(pointers[i]);
+    }
+    catch(std::bad_alloc&) {
+      ++rejected;
+    }
+  }
+  std::cout << " rejected " << rejected << " of " << cCount << " double frees\n";
+
+  if(rejected != cCount || !fibonacci->isCorrectEmpty()) {
+    std::cout << "########## !!!!!!!!!!!!!!!!! corrupt after freeing everything !!!!!!!!!!!!!!!!!!\n";
+  }
+  else {  // nothing to do
+  }
+  std::cout << cSeparator;
+  delete[] mem;
+}
+
+bool checkPattern(uint8_t const * const aPointer, size_t const aSize) {
+  bool result = true;
+  for(size_t i = 0u; i < aSize; ++i) {
+    result = result && aPointer[i] == static_cast<uint8_t>(i);
+  }
+  return result;
+}
+
+/// @returns the resident set size in kB, or 0 if unknown.
+size_t getResidentSize() {
+  size_t result = 0u;
+#if defined(__linux__)
+  std::ifstream statm("/proc/self/statm");
+  size_t total;
+  size_t resident;
+  if(statm >> total >> resident) {
+    result = resident * static_cast<size_t>(sysconf(_SC_PAGESIZE)) / 1024u;
+  }
+  else { // nothing to do
+  }
+#endif
+  return result;
+}
+
+constexpr FibonacciTables<10u, 1u> cClassicTables = FibonacciTables<10u, 1u>();
+static_assert(cClassicTables.mFibonaccis[0u] == 1u && cClassicTables.mFibonaccis[9u] == 89u, "The classic Fibonacci numbers starting 1, 2.");
+static_assert(cClassicTables.mDirections[1u][9u * 10u + 9u].getDirection() == FibonacciDirection::cHere, "A block of the target index is used in place.");
+constexpr FibonacciTables<8u, 2u> cDifferenceTables = FibonacciTables<8u, 2u>();
+static_assert(cDifferenceTables.mFibonaccis[3u] == 4u && cDifferenceTables.mFibonaccis[7u] == 19u, "F[i] = F[i - 1] + F[i - 3] from 1, 2, 3.");
+
+/// The Fibonacci numbers as the manager computed them in its memory before FibonacciTables.
+std::vector<size_t> calculateFibonaccisAtRunTime(size_t const aCount, size_t const aDifference) {
+  std::vector<size_t> result(aCount);
+  for(size_t i = 0u; i < aCount; ++i) {
+    result[i] = (i <= aDifference ? i + 1u : result[i - 1u] + result[i - 1u - aDifference]);
+  }
+  return result;
+}
+
+/// The allocation directions as the manager filled them in its memory before FibonacciTables, indexed by i * aCount + j.
+std::vector<FibonacciCell> fillDirectionsAtRunTime(size_t const aCount, size_t const aDifference, bool const aExact) {
+  std::vector<FibonacciCell> result(aCount * aCount);
+  for(size_t i = 0u; i < aCount; ++i) {
+    result[i * aCount + i].set(true);
+  }
+  for(size_t i = 1u; i <= aDifference; ++i) {
+    for(size_t j = 0u; j < i; ++j) {
+      result[i * aCount + j].set(false);
+    }
+  }
+  for(size_t i = aDifference + 1u; i < aCount; ++i) {
+    for(size_t j = 0u; j < i; ++j) {
+      FibonacciCell const& leftChild = result[(i - aDifference - 1u) * aCount + j];
+      FibonacciCell const& rightChild = result[(i - 1u) * aCount + j];
+      if(aExact && j <= i - aDifference - 1u && leftChild.isExact()) {
+        result[i * aCount + j].set(true, FibonacciDirection::cLeft);
+      }
+      else if(aExact && rightChild.isExact()) {
+        result[i * aCount + j].set(true, FibonacciDirection::cRight);
+      }
+      else if(j <= i - aDifference - 1u) {
+        result[i * aCount + j].set(!aExact && leftChild.isExact(), FibonacciDirection::cLeft);
+      }
+      else {
+        result[i * aCount + j].set(!aExact && rightChild.isExact(), FibonacciDirection::cRight);
+      }
+    }
+  }
+  return result;
+}
+
+template<size_t tCount, size_t tDifference>
+bool checkTables() {
+  static constexpr FibonacciTables<tCount, tDifference> cTables = FibonacciTables<tCount, tDifference>();
+  constexpr size_t cBitsPerWord = FibonacciTables<tCount, tDifference>::cBitsPerWord;
+  constexpr size_t cBitmapWords = FibonacciTables<tCount, tDifference>::cBitmapWords;
+  std::vector<size_t> fibonaccis = calculateFibonaccisAtRunTime(tCount, tDifference);
+  bool result = std::equal(fibonaccis.cbegin(), fibonaccis.cend(), cTables.mFibonaccis);
+  for(size_t exact = 0u; exact < 2u; ++exact) {
+    std::vector<FibonacciCell> directions = fillDirectionsAtRunTime(tCount, tDifference, exact == 1u);
+    for(size_t k = 0u; k < tCount * tCount; ++k) {
+      result = result && directions[k].isExact() == cTables.mDirections[exact][k].isExact() &&
+                         directions[k].getDirection() == cTables.mDirections[exact][k].getDirection();
+    }
+    for(size_t j = 0u; exact == 1u && j < tCount; ++j) {
+      for(size_t i = 0u; i < tCount; ++i) {
+        bool masked = (cTables.mExactMasks[j * cBitmapWords + i / cBitsPerWord] & (static_cast<size_t>(1u) << (i % cBitsPerWord))) != 0u;
+        result = result && masked == (i >= j && directions[i * tCount + j].isExact());
+      }
+    }
+  }
+  return result;
+}
+
+void testTables() {
+  std::cout << "Testing the compile time tables against the former run time fill\n";
+  bool correct = checkTables<40u, cFibonacciDifference>() && checkTables<70u, 1u>() && checkTables<30u, 2u>() && checkTables<25u, 8u>();
+  std::cout << " 4 parameter sets " << (correct ? "match" : "differ") << '\n';
+
+  if(!correct) {
+    std::cout << "########## !!!!!!!!!!!!!!!!! corrupt tables !!!!!!!!!!!!!!!!!!\n";
+  }
+  else {  // nothing to do
+  }
+  std::cout << cSeparator;
+}
+
+/// Replays a random churn against the linear searches the manager used before the occupancy bitmap: the reverse scan
+/// for the largest free index, upper_bound for the suitable index, and the scans for the first index having a free block
+/// that splits into it exactly, or having any. The lowest free block of the chosen index is split along the directions.
+void testFreeIndexSearch(bool const aExact) {
+  uint8_t* mem = new uint8_t[cMemorySize];
+  Fibonacci* fibonacci = new(mem) Fibonacci(mem, aExact);
+  std::cout << "Testing the free index search against linear scans with exact = " << aExact << '\n';
+
+  size_t const count = fibonacci->getFibonacciCount();
+  size_t const blockSize = fibonacci->getTechnicalBlockSize();
+  std::vector<size_t> fibonaccis(count);
+  for(size_t i = 0u; i < count; ++i) {
+    fibonaccis[i] = fibonacci->getFibonacci(i);
+  }
+  std::vector<FibonacciCell> directions = fillDirectionsAtRunTime(count, cFibonacciDifference, aExact);
+  std::default_random_engine generator(6u);
+  std::uniform_int_distribution<size_t> sizeDistribution(1u, cBenchmarkAllocSize * 8u);
+  std::vector<void*> live;
+  size_t mismatches = 0u;
+  size_t splits = 0u;
+  for(size_t step = 0u; step < cBenchmarkAllocCount; ++step) {
+    std::vector<uint8_t*> lowestFree(count, nullptr);
+    for(auto block : fibonacci->getBlocks()) {
+      if(block.mFree && lowestFree[block.mIndex] == nullptr) {
+        lowestFree[block.mIndex] = static_cast<uint8_t*>(block.mStart);
+      }
+      else { // nothing to do
+      }
+    }
+    size_t largest = count - 1u;
+    while(largest < count && lowestFree[largest] == nullptr) {
+      --largest;
+    }
+    mismatches += (fibonacci->getLargestFreeIndex() == std::min(largest, count) ? 0u : 1u);
+    if(live.size() < cBenchmarkAllocCount / 4u && (live.empty() || generator() % 3u != 0u)) {
+      size_t size = sizeDistribution(generator);
+      size_t units = (size + Fibonacci::getHeaderSize() + blockSize - 1u) / blockSize;
+      size_t suitable = static_cast<size_t>(std::upper_bound(fibonaccis.cbegin(), fibonaccis.cend(), units) - fibonaccis.cbegin());
+      suitable -= (suitable > 0u && fibonaccis[suitable - 1u] == units ? 1u : 0u);
+      size_t index = suitable;
+      while(aExact && index < count && (lowestFree[index] == nullptr || !directions[index * count + suitable].isExact())) {
+        ++index;
+      }
+      if(!aExact || index == count) {
+        index = suitable;
+        while(index < count && lowestFree[index] == nullptr) {
+          ++index;
+        }
+      }
+      else { // nothing to do
+      }
+      uint8_t* expected = lowestFree[index];
+      while(index > suitable && directions[index * count + suitable].getDirection() != FibonacciDirection::cHere) {
+        size_t leftIndex = index - cFibonacciDifference - 1u;
+        bool right = directions[index * count + suitable].getDirection() == FibonacciDirection::cRight;
+        expected += (right ? blockSize * fibonaccis[leftIndex] : 0u);
+        index = (right ? index - 1u : leftIndex);
+        ++splits;
+      }
+      live.push_back(fibonacci->allocate(size));
+      mismatches += (fibonacci->getSuitableIndex(size) == suitable && live.back() == expected + Fibonacci::getHeaderSize() ? 0u : 1u);
+    }
+    else {
+      size_t victim = generator() % live.size();
+      fibonacci->deallocate(live[victim]);
+      live[victim] = live.back();
+      live.pop_back();
+    }
+  }
+  std::cout << " " << cBenchmarkAllocCount << " steps with " << splits << " splits, " << mismatches << " mismatches\n";
+  for(auto pointer : live) {
+    fibonacci->deallocate(pointer);
+  }
+
+  if(mismatches > 0u || !fibonacci->isCorrectEmpty()) {
+    std::cout << "########## !!!!!!!!!!!!!!!!! corrupt after freeing everything !!!!!!!!!!!!!!!!!!\n";
+  }
+  else {  // nothing to do
+  }
+  std::cout << cSeparator;
+  delete[] mem;
+}
+
+void testDecommit(bool const aExact) {
+  constexpr size_t cBlockCount = 8u;
+  constexpr size_t cBlockSize  = 1024u * 1024u;
+  uint8_t* mem = new uint8_t[cMemorySize];
+  DecommitFibonacci* fibonacci = new(mem) DecommitFibonacci(mem, aExact);
+  std::cout << "Testing decommitting free blocks with exact = " << aExact << '\n';
+
+  uint8_t* pointers[cBlockCount];
+  for(size_t i = 0u; i < cBlockCount; ++i) {
+    pointers[i] = static_cast<uint8_t*>(fibonacci->allocate(cBlockSize));
+    std::fill(pointers[i], pointers[i] + cBlockSize, static_cast<uint8_t>(i));
+  }
+  size_t residentPeak = getResidentSize();
+  DecommitInterface::sDecommitted = 0u;
+  for(size_t i = 0u; i < cBlockCount; ++i) {
+    fibonacci->deallocate(pointers[i]);
+  }
+  size_t residentFreed = getResidentSize();
+  std::cout << " decommitted " << DecommitInterface::sDecommitted / 1024u << " kB, resident size went from " << residentPeak << " kB to " << residentFreed << " kB\n";
+  bool correct = DecommitInterface::sDecommitted < cMemorySize; // each page at most once
+  for(size_t i = 0u; i < cBlockCount; ++i) {
+    pointers[i] = static_cast<uint8_t*>(fibonacci->allocate(cBlockSize));
+    std::fill(pointers[i], pointers[i] + cBlockSize, static_cast<uint8_t>(i));
+  }
+  for(size_t i = 0u; i < cBlockCount; ++i) {
+    correct = correct && pointers[i][0u] == static_cast<uint8_t>(i) && pointers[i][cBlockSize - 1u] == static_cast<uint8_t>(i);
+    fibonacci->deallocate(pointers[i]);
+  }
+  correct = correct && fibonacci->isCorrectEmpty();
+
+  // On a fresh heap a decommitted block of index cSplitIndex is split for its right child, and its left child
+  // of index cSplitIndex - 4 must be passed over for a committed free one of the same index at a higher address.
+  constexpr size_t cSplitIndex = 24u;
+  fibonacci = new(mem) DecommitFibonacci(mem, aExact);
+  void* left = fibonacci->allocate(fibonacci->getUserBlockSize(cSplitIndex - 4u));
+  void* decommitted = fibonacci->allocate(fibonacci->getUserBlockSize(cSplitIndex));
+  void* right = fibonacci->allocate(fibonacci->getUserBlockSize(cSplitIndex - 1u)); // leaves a committed free block of index cSplitIndex - 4
+  fibonacci->deallocate(decommitted);
+  void* split = fibonacci->allocate(fibonacci->getUserBlockSize(cSplitIndex - 1u));
+  void* committed = fibonacci->allocate(fibonacci->getUserBlockSize(cSplitIndex - 4u));
+  std::cout << " after splitting a decommitted block the " << (committed == decommitted ? "decommitted" : "committed") << " child is preferred\n";
+  correct = correct && static_cast<uint8_t*>(split) > static_cast<uint8_t*>(decommitted) && static_cast<uint8_t*>(committed) > static_cast<uint8_t*>(decommitted);
+  fibonacci->deallocate(left);
+  fibonacci->deallocate(right);
+  fibonacci->deallocate(split);
+  fibonacci->deallocate(committed);
+
+  if(!correct || !fibonacci->isCorrectEmpty()) {
+    std::cout << "########## !!!!!!!!!!!!!!!!! corrupt after freeing everything !!!!!!!!!!!!!!!!!!\n";
+  }
+  else {  // nothing to do
+  }
+  std::cout << cSeparator;
+  delete[] mem;
+}
+
+void testReallocate(bool const aExact) {
+  uint8_t* mem = new uint8_t[cMemorySize];
+  Fibonacci* fibonacci = new(mem) Fibonacci(mem, aExact);
+  std::cout << "Testing reallocate with exact = " << aExact << '\n';
+
+  size_t size = 100u;
+  uint8_t* pointer = static_cast<uint8_t*>(fibonacci->allocate(size));
+  for(size_t i = 0u; i < size; ++i) {
+    pointer[i] = static_cast<uint8_t>(i);
+  }
+  size_t inPlace = 0u;
+  size_t steps = 0u;
+  bool correct = true;
+  for(size_t newSize = size * 2u; newSize < fibonacci->getMaxUserBlockSize() / 4u; newSize *= 2u) {
+    uint8_t* newPointer = static_cast<uint8_t*>(fibonacci->reallocate(pointer, newSize));
+    inPlace += (newPointer == pointer ? 1u : 0u);
+    ++steps;
+    correct = correct && checkPattern(newPointer, size);
+    for(size_t i = size; i < newSize; ++i) {
+      newPointer[i] = static_cast<uint8_t>(i);
+    }
+    pointer = newPointer;
+    size = newSize;
+  }
+  std::cout << " grown to " << size << " bytes in " << steps << " steps, " << inPlace << " of them in place\n";
+  uint8_t* newPointer = static_cast<uint8_t*>(fibonacci->reallocate(pointer, 100u));
+  correct = correct && newPointer == pointer && checkPattern(newPointer, 100u);
+  std::cout << " shrunk to 100 bytes " << (newPointer == pointer ? "in place" : "by copying") << '\n';
+  uint8_t* blocker = static_cast<uint8_t*>(fibonacci->allocate(100u)); // probably takes the right buddy
+  newPointer = static_cast<uint8_t*>(fibonacci->reallocate(pointer, size));
+  correct = correct && checkPattern(newPointer, 100u);
+  std::cout << " grown back to " << size << " bytes " << (newPointer == pointer ? "in place" : "by copying") << '\n';
+  fibonacci->deallocate(newPointer);
+  fibonacci->deallocate(blocker);
+
+  if(!correct || !fibonacci->isCorrectEmpty()) {
+    std::cout << "########## !!!!!!!!!!!!!!!!! corrupt after freeing everything !!!!!!!!!!!!!!!!!!\n";
+  }
+  else {  // nothing to do
+  }
+  std::cout << cSeparator;
+  delete[] mem;
+}
+
+/// Allocates and frees a few blocks of the same sizes over and over.
+template<typename tNewDelete>
+void benchmarkChurn(char const * const aName) {
+  uint8_t* mem = new uint8_t[cMemorySize];
+  tNewDelete::init(reinterpret_cast<void*>(mem), false);
+
+  std::array<uint8_t*, 8u> live;
+  auto begin = std::chrono::high_resolution_clock::now();
+  for(size_t i = 0u; i < cThreadAllocCount; ++i) {
+    for(size_t j = 0u; j < live.size(); ++j) {
+      live[j] = tNewDelete::template _newArray<uint8_t>(cThreadSmallSize + j * cThreadSmallSize);
+    }
+    for(size_t j = 0u; j < live.size(); ++j) {
+      tNewDelete::_deleteArray(live[j]);
+    }
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  auto timeSpan = std::chrono::duration_cast<std::chrono::duration<double>>(end - begin);
+  std::cout << cThreadAllocCount << " times allocating and freeing " << live.size() << " blocks using " << aName << " took " << timeSpan.count() << '\n';
+
+  if(!tNewDelete::isCorrectEmpty()) {
+    std::cout << "########## !!!!!!!!!!!!!!!!! corrupt after freeing everything !!!!!!!!!!!!!!!!!!\n";
+  }
+  else {  // nothing to do
+  }
+  std::cout << cSeparator;
+  delete[] mem;
+}
+
+/// Measures ping-pong allocations among many scattered free blocks, and the fragmentation left by a random churn.
+/// aLastFreedFirst tells if a released block must be reused before a lower free one.
+template<typename tNewDelete>
+void benchmarkReuse(char const * const aName, bool const aLastFreedFirst) {
+  uint8_t* mem = new uint8_t[cMemorySize];
+  tNewDelete::init(reinterpret_cast<void*>(mem), false);
+  std::cout << "Benchmarking block reuse of " << aName << '\n';
+
+  std::vector<uint8_t*> full;
+  try {
+    while(true) {
+      full.push_back(tNewDelete::template _newArray<uint8_t>(1u));
+    }
+  }
+  catch(std::bad_alloc&) { // even the smallest blocks are used, so the blocks freed below are not merged
+  }
+  size_t last = full.size() - 1u;
+  while(tNewDelete::getUsableSize(full[last]) != tNewDelete::getUsableSize(full[1u])) {
+    --last;
+  }
+  tNewDelete::_deleteArray(full[1u]);
+  tNewDelete::_deleteArray(full[last]);
+  uint8_t* first = tNewDelete::template _newArray<uint8_t>(1u);
+  bool correct = first == (aLastFreedFirst ? full[last] : full[1u]);
+  full[1u] = first;
+  full[last] = tNewDelete::template _newArray<uint8_t>(1u);
+  for(auto pointer : full) {
+    tNewDelete::_deleteArray(pointer);
+  }
+
+  std::default_random_engine generator(1u);
+  std::uniform_int_distribution<size_t> distribution(1u, cBenchmarkAllocSize * 4u);
+  std::vector<uint8_t*> live(cBenchmarkAllocCount, nullptr);
+  for(size_t i = 0u; i < live.size(); ++i) {
+    live[i] = tNewDelete::template _newArray<uint8_t>(distribution(generator));
+  }
+  for(size_t i = 0u; i < live.size(); i += 2u) {
+    tNewDelete::_deleteArray(live[i]);
+    live[i] = nullptr;
+  }
+  std::array<uint8_t*, 4u> pingPong;
+  auto begin = std::chrono::high_resolution_clock::now();
+  for(size_t i = 0u; i < cThreadAllocCount; ++i) {
+    for(size_t j = 0u; j < pingPong.size(); ++j) {
+      pingPong[j] = tNewDelete::template _newArray<uint8_t>(cThreadSmallSize + j * cThreadSmallSize);
+      std::fill(pingPong[j], pingPong[j] + cThreadSmallSize, static_cast<uint8_t>(j));
+    }
+    for(size_t j = 0u; j < pingPong.size(); ++j) {
+      tNewDelete::_deleteArray(pingPong[j]);
+    }
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  auto timeSpan = std::chrono::duration_cast<std::chrono::duration<double>>(end - begin);
+  std::cout << " " << cThreadAllocCount << " times allocating and freeing " << pingPong.size() << " blocks among " << live.size() / 2u << " free ones took " << timeSpan.count() << '\n';
+
+  begin = std::chrono::high_resolution_clock::now();
+  for(size_t i = 0u; i < cThreadAllocCount; ++i) {
+    size_t slot = distribution(generator) % live.size();
+    tNewDelete::_deleteArray(live[slot]);
+    live[slot] = tNewDelete::template _newArray<uint8_t>(distribution(generator));
+  }
+  end = std::chrono::high_resolution_clock::now();
+  timeSpan = std::chrono::duration_cast<std::chrono::duration<double>>(end - begin);
+  size_t freeSpace = tNewDelete::getFreeSpace();
+  size_t maxFree = tNewDelete::getMaxFreeUserBlockSize();
+  std::cout << " " << cThreadAllocCount << " random replacements took " << timeSpan.count() << ", free space: " << freeSpace <<
+               " largest free block: " << maxFree << " external fragmentation: " << 1.0 - static_cast<double>(maxFree) / static_cast<double>(freeSpace) << '\n';
+
+  for(auto pointer : live) {
+    tNewDelete::_deleteArray(pointer);
+  }
+  if(!correct || !tNewDelete::isCorrectEmpty()) {
+    std::cout << "########## !!!!!!!!!!!!!!!!! corrupt after freeing everything !!!!!!!!!!!!!!!!!!\n";
+  }
+  else {  // nothing to do
+  }
+  std::cout << cSeparator;
+  delete[] mem;
+}
+
+template<typename tNewDelete>
+void testStatistics(bool const aExact) {
+  uint8_t* mem = new uint8_t[cMemorySize];
+  tNewDelete::init(reinterpret_cast<void*>(mem), aExact);
+  std::cout << "Testing statistics with exact = " << aExact << '\n';
+
+  std::default_random_engine generator(1u);
+  std::uniform_int_distribution<size_t> distribution(1u, cBenchmarkAllocSize * 4u);
+  std::vector<uint8_t*> live;
+  size_t requested = 0u;
+  for(size_t i = 0u; i < cBenchmarkAllocCount; ++i) {
+    size_t size = distribution(generator);
+    live.push_back(tNewDelete::template _newArray<uint8_t>(size));
+    requested += size;
+    if(i % 3u == 2u) {
+      tNewDelete::_deleteArray(live[i / 2u]);
+      live[i / 2u] = nullptr;
+    }
+    else { // nothing to do
+    }
+  }
+  try {
+    tNewDelete::template _newArray<uint8_t>(cMemorySize);
+  }
+  catch (std::bad_alloc&) { // counted as a failure
+  }
+  auto statistics = tNewDelete::getStatistics();
+  std::cout << " used: " << statistics.mUsed << " peak: " << statistics.mPeakUsed << " failures: " << statistics.mFailures <<
+               " splits: " << statistics.mSplits << " merges: " << statistics.mMerges << '\n';
+  std::cout << " internal fragmentation: " << statistics.getInternalFragmentation() << " of " << statistics.mGrantedBytes <<
+               " bytes, external fragmentation: " << statistics.getExternalFragmentation() <<
+               ", waiting for locks: " << statistics.mLockNanoseconds / 1000u << " us\n";
+  std::cout << " index: allocations/deallocations";
+  size_t allocations = 0u;
+  size_t deallocations = 0u;
+  for(size_t i = 0u; i < statistics.mIndexCount; ++i) {
+    if(statistics.mAllocations[i] > 0u) {
+      std::cout << ' ' << i << ": " << statistics.mAllocations[i] << '/' << statistics.mDeallocations[i];
+    }
+    else { // nothing to do
+    }
+    allocations += statistics.mAllocations[i];
+    deallocations += statistics.mDeallocations[i];
+  }
+  std::cout << '\n';
+  bool correct = allocations == cBenchmarkAllocCount && deallocations == cBenchmarkAllocCount / 3u &&
+                 statistics.mFailures >= 1u && statistics.mRequestedBytes == requested && statistics.mPeakUsed >= statistics.mUsed;
+
+  for(auto pointer : live) {
+    tNewDelete::_deleteArray(pointer);
+  }
+  if(!correct || !tNewDelete::isCorrectEmpty()) {
+    std::cout << "########## !!!!!!!!!!!!!!!!! corrupt after freeing everything !!!!!!!!!!!!!!!!!!\n";
+  }
+  else {  // nothing to do
+  }
+  std::cout << cSeparator;
+  delete[] mem;
+}
+
+void testHeapWalk(bool const aExact) {
+  uint8_t* mem = new uint8_t[cMemorySize];
+  ExampleNewDelete::init(reinterpret_cast<void*>(mem), aExact);
+  std::cout << "Testing heap walk and dump with exact = " << aExact << '\n';
+
+  std::default_random_engine generator(2u);
+  std::uniform_int_distribution<size_t> distribution(1u, cBenchmarkAllocSize * 4u);
+  std::vector<uint8_t*> live;
+  for(size_t i = 0u; i < cBenchmarkAllocCount; ++i) {
+    live.push_back(ExampleNewDelete::_newArray<uint8_t>(distribution(generator)));
+  }
+  for(size_t i = 0u; i < live.size(); i += 2u) {
+    ExampleNewDelete::_deleteArray(live[i]);
+    live[i] = nullptr;
+  }
+  size_t usedCount = 0u;
+  size_t freeCount = 0u;
+  size_t freeSpace = 0u;
+  size_t heapSize = 0u;
+  for(auto block : ExampleNewDelete::getBlocks()) {
+    usedCount += (block.mFree ? 0u : 1u);
+    freeCount += (block.mFree ? 1u : 0u);
+    freeSpace += (block.mFree ? block.mSize - ExampleNewDelete::getAlignment() : 0u);
+    heapSize += block.mSize;
+  }
+  size_t dumpSize = ExampleNewDelete::dump(nullptr, 0u);
+  std::vector<uint8_t> dump(dumpSize);
+  bool correct = ExampleNewDelete::dump(dump.data(), dump.size()) == dumpSize && dump[0u] == 'F' && dump[3u] == 'H' && dump[4u] == 2u &&
+                 usedCount == cBenchmarkAllocCount / 2u && freeSpace == ExampleNewDelete::getFreeSpace() &&
+                 heapSize == ExampleNewDelete::getMaxUserBlockSize() + ExampleNewDelete::getAlignment();
+  std::cout << " " << usedCount << " used and " << freeCount << " free blocks, dump of " << dumpSize << " bytes\n";
+
+  for(auto pointer : live) {
+    ExampleNewDelete::_deleteArray(pointer);
+  }
+  if(!correct || !ExampleNewDelete::isCorrectEmpty()) {
+    std::cout << "########## !!!!!!!!!!!!!!!!! corrupt after freeing everything !!!!!!!!!!!!!!!!!!\n";
+  }
+  else {  // nothing to do
+  }
+  std::cout << cSeparator;
+  delete[] mem;
+}
+
+/// Allocates many tiny objects and returns how much space they took.
+template<typename tNewDelete>
+size_t benchmarkTiny(char const * const aName, bool const aExact, bool& aCorrect) {
+  uint8_t* mem = new uint8_t[cMemorySize];
+  tNewDelete::init(reinterpret_cast<void*>(mem), aExact);
+
+  std::default_random_engine generator(5u);
+  std::uniform_int_distribution<size_t> distribution(1u, 64u);
+  std::vector<uint8_t*> live(cDiverseAllocCount * 5u);
+  size_t freeBefore = tNewDelete::getFreeSpace();
+  auto begin = std::chrono::high_resolution_clock::now();
+  for(size_t i = 0u; i < live.size(); ++i) {
+    size_t size = distribution(generator);
+    live[i] = tNewDelete::template _newArray<uint8_t>(size);
+    std::fill(live[i], live[i] + size, static_cast<uint8_t>(i));
+  }
+  size_t used = freeBefore - tNewDelete::getFreeSpace();
+  for(size_t i = 0u; i < live.size(); ++i) {
+    aCorrect = aCorrect && live[i][0u] == static_cast<uint8_t>(i);
+    tNewDelete::_deleteArray(live[i]);
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  auto timeSpan = std::chrono::duration_cast<std::chrono::duration<double>>(end - begin);
+  std::cout << " " << live.size() << " objects of 1-64 bytes took " << used << " bytes and " << timeSpan.count() << " s using " << aName << '\n';
+  aCorrect = tNewDelete::isCorrectEmpty() && aCorrect;
+  delete[] mem;
+  return used;
+}
+
+void testSlabs(bool const aExact) {
+  std::cout << "Testing slabs with exact = " << aExact << '\n';
+  bool correct = true;
+  size_t withSlabs = benchmarkTiny<SlabNewDelete>("slabs", aExact, correct);
+  size_t withoutSlabs = benchmarkTiny<IntrusiveNewDelete>("blocks", aExact, correct);
+  correct = correct && withSlabs < withoutSlabs / 2u;
+
+  uint8_t* mem = new uint8_t[cMemorySize];
+  SlabFibonacci* fibonacci = new(mem) SlabFibonacci(mem, aExact);
+  uint8_t* slot = static_cast<uint8_t*>(fibonacci->allocate(24u));
+  std::fill(slot, slot + 24u, 24u);
+  correct = correct && fibonacci->getBlockIndex(slot) == fibonacci->getFibonacciCount();
+  correct = correct && fibonacci->reallocate(slot, 16u) == slot && fibonacci->reallocate(slot, 24u) == slot;
+  uint8_t* grown = static_cast<uint8_t*>(fibonacci->reallocate(slot, 1000u));
+  correct = correct && grown != slot && grown[23u] == 24u && fibonacci->getBlockIndex(grown) < fibonacci->getFibonacciCount();
+  fibonacci->deallocate(grown);
+  fibonacci->coalesce();
+  correct = correct && fibonacci->isCorrectEmpty();
+
+  if(!correct) {
+    std::cout << "########## !!!!!!!!!!!!!!!!! corrupt after freeing everything !!!!!!!!!!!!!!!!!!\n";
+  }
+  else {  // nothing to do
+  }
+  std::cout << cSeparator;
+  delete[] mem;
+}
+
+void testPersistence(bool const aExact) {
+  uint8_t* mem = new uint8_t[cMemorySize / 32u];
+  PersistentNewDelete::init(reinterpret_cast<void*>(mem), aExact);
+  std::cout << "Testing position independent heap with exact = " << aExact << '\n';
+
+  std::default_random_engine generator(6u);
+  std::uniform_int_distribution<size_t> distribution(1u, cBenchmarkAllocSize);
+  std::vector<size_t> offsets;  // the application would keep these in the heap instead of pointers
+  std::vector<size_t> sizes;
+  for(size_t i = 0u; i < cBenchmarkAllocCount / 20u; ++i) {
+    size_t size = (i % 2u == 0u ? distribution(generator) % 64u + 1u : distribution(generator));
+    uint8_t* pointer = PersistentNewDelete::_newArray<uint8_t>(size);
+    std::fill(pointer, pointer + size, static_cast<uint8_t>(i));
+    offsets.push_back(static_cast<size_t>(pointer - mem));
+    sizes.push_back(size);
+  }
+  for(size_t i = 0u; i < offsets.size(); i += 3u) {
+    PersistentNewDelete::_deleteArray(mem + offsets[i]);
+    sizes[i] = 0u;
+  }
+
+  uint8_t* moved = new uint8_t[cMemorySize / 32u];
+  std::copy(mem, mem + cMemorySize / 32u, moved);
+  std::fill(mem, mem + cMemorySize / 32u, 0xffu);
+  delete[] mem;
+  PersistentNewDelete::attach(reinterpret_cast<void*>(moved));
+
+  bool correct = true;
+  for(size_t i = 0u; i < offsets.size(); ++i) {
+    correct = correct && std::count(moved + offsets[i], moved + offsets[i] + sizes[i], static_cast<uint8_t>(i)) == static_cast<ptrdiff_t>(sizes[i]);
+    if(sizes[i] == 0u) {
+      size_t size = distribution(generator);
+      uint8_t* pointer = PersistentNewDelete::_newArray<uint8_t>(size);
+      std::fill(pointer, pointer + size, static_cast<uint8_t>(i));
+      offsets[i] = static_cast<size_t>(pointer - moved);
+      sizes[i] = size;
+    }
+    else { // nothing to do
+    }
+  }
+  for(size_t i = 0u; i < offsets.size(); ++i) {
+    correct = correct && std::count(moved + offsets[i], moved + offsets[i] + sizes[i], static_cast<uint8_t>(i)) == static_cast<ptrdiff_t>(sizes[i]);
+    PersistentNewDelete::_deleteArray(moved + offsets[i]);
+  }
+  std::cout << " " << offsets.size() << " arrays survived moving the heap\n";
+
+  if(!correct || !PersistentNewDelete::isCorrectEmpty()) {
+    std::cout << "########## !!!!!!!!!!!!!!!!! corrupt after freeing everything !!!!!!!!!!!!!!!!!!\n";
+  }
+  else {  // nothing to do
+  }
+  std::cout << cSeparator;
+  delete[] moved;
+}
+
+void testHeaderless(bool const aExact) {
+  uint8_t* mem = new uint8_t[cMemorySize];
+  HeaderlessFibonacci* fibonacci = new(mem) HeaderlessFibonacci(mem, aExact);
+  std::cout << "Testing headerless blocks and sized deallocation with exact = " << aExact << '\n';
+  bool correct = true;
+  std::vector<uint8_t*> blocks;
+  for(size_t i = 0u; i < fibonacci->getFibonacciCount() / 2u; ++i) {
+    size_t size = fibonacci->getTechnicalBlockSize() * fibonacci->getFibonacci(i); // the whole block
+    uint8_t* pointer = static_cast<uint8_t*>(fibonacci->allocate(size));
+    std::fill(pointer, pointer + size, static_cast<uint8_t>(i));
+    size_t fibonacciIndex = fibonacci->getBlockIndex(pointer); // the small ones may be larger
+    correct = correct && fibonacciIndex < fibonacci->getFibonacciCount() && fibonacci->getUserBlockSize(fibonacciIndex) >= size;
+    blocks.push_back(pointer);
+  }
+  uint8_t* page = static_cast<uint8_t*>(fibonacci->allocateAligned(5000u, 4096u));
+  correct = correct && reinterpret_cast<uintptr_t>(page) % 4096u == 0u;
+  for(size_t i = 0u; i < blocks.size(); ++i) {
+    size_t size = fibonacci->getTechnicalBlockSize() * fibonacci->getFibonacci(i);
+    correct = correct && std::count(blocks[i], blocks[i] + size, static_cast<uint8_t>(i)) == static_cast<ptrdiff_t>(size);
+    fibonacci->deallocate(blocks[i], size);
+  }
+  try {
+    fibonacci->deallocate(page, 2u * fibonacci->getMaxUserBlockSize());
+    correct = false;
+  }
+  catch(std::bad_alloc&) { // too large for the block, which stays allocated
+  }
+  fibonacci->deallocate(page, 5000u);
+  correct = correct && fibonacci->isCorrectEmpty();
+
+  uint8_t* slabMem = new uint8_t[cMemorySize];
+  SlabFibonacci* slabs = new(slabMem) SlabFibonacci(slabMem, aExact);
+  void* slot = slabs->allocate(24u);
+  void* neighbour = slabs->allocate(24u);
+  void* block = slabs->allocate(1000u);
+  uint32_t fakeHeader = 1u; // a used block of index 1, if the end of the slot before were taken for the header of neighbour
+  correct = correct && static_cast<uint8_t*>(neighbour) == static_cast<uint8_t*>(slot) + 24u;
+  std::memcpy(static_cast<uint8_t*>(neighbour) - SlabFibonacci::getHeaderSize(), &fakeHeader, sizeof(fakeHeader));
+  try {
+    slabs->deallocate(neighbour, SlabFibonacci::getMaxSlotSize() + 1u); // larger than any slot
+    correct = false;
+  }
+  catch(std::bad_alloc&) { // the slot stays allocated
+  }
+  slabs->deallocate(neighbour, 24u);
+  slabs->deallocate(slot, 24u);
+  slabs->deallocate(block, 1000u);
+  slabs->coalesce();
+  correct = correct && slabs->isCorrectEmpty();
+
+  std::fill(slabMem, slabMem + cMemorySize, static_cast<uint8_t>(0x5au)); // the table must not trust leftovers
+  HeaderlessSlabFibonacci* headerlessSlabs = new(slabMem) HeaderlessSlabFibonacci(slabMem, aExact);
+  std::vector<void*> grown;
+  for(size_t i = 0u; i < 16u; ++i) {
+    grown.push_back(headerlessSlabs->allocate(1000u));
+  }
+  for(size_t i = 1u; i < grown.size(); i += 2u) {
+    headerlessSlabs->deallocate(grown[i], 1000u);
+  }
+  for(size_t i = 0u; i < grown.size(); i += 2u) { // absorbs freed buddies, leaving entries behind
+    grown[i] = headerlessSlabs->reallocate(grown[i], 1500u);
+    headerlessSlabs->deallocate(grown[i], 1500u);
+  }
+  std::vector<void*> slots;
+  for(size_t i = 0u; i < 256u; ++i) {
+    slots.push_back(headerlessSlabs->allocate(HeaderlessSlabFibonacci::getMaxSlotSize()));
+  }
+  size_t rejected = 0u;
+  for(void* pointer : slots) { // the slots on unit boundaries skip the slab lookup
+    try {
+      headerlessSlabs->deallocate(pointer, HeaderlessSlabFibonacci::getMaxSlotSize() + 1u);
+    }
+    catch(std::bad_alloc&) {
+      ++rejected;
+    }
+    headerlessSlabs->deallocate(pointer, HeaderlessSlabFibonacci::getMaxSlotSize());
+  }
+  headerlessSlabs->coalesce();
+  correct = correct && rejected == slots.size() && headerlessSlabs->isCorrectEmpty();
+
+  BusyRemoteFreeFibonacci* remote = new(slabMem) BusyRemoteFreeFibonacci(slabMem, aExact);
+  void* contended = remote->allocate(1000u);
+  BusyLock::sBusy = true;
+  try {
+    remote->deallocate(contended, 2u * remote->getMaxUserBlockSize()); // checked before pushing it for remote free
+    correct = false;
+  }
+  catch(std::bad_alloc&) { // the block stays allocated
+  }
+  remote->deallocate(contended, 1000u);
+  BusyLock::sBusy = false;
+  remote->coalesce();
+  correct = correct && remote->isCorrectEmpty();
+  std::cout << " " << blocks.size() << " blocks used to their last byte\n";
+
+  if(!correct) {
+    std::cout << "########## !!!!!!!!!!!!!!!!! corrupt after freeing everything !!!!!!!!!!!!!!!!!!\n";
+  }
+  else {  // nothing to do
+  }
+  std::cout << cSeparator;
+  delete[] slabMem;
+  delete[] mem;
+}
+
+void testRemoteFreeDoubleFree(bool const aExact) {
+  uint8_t* mem = new uint8_t[cMemorySize];
+  BusySlabFibonacci* fibonacci = new(mem) BusySlabFibonacci(mem, aExact);
+  std::cout << "Testing double frees pushed for remote free with exact = " << aExact << '\n';
+  constexpr size_t cCount = 8u;
+  void* pointers[cCount];
+  for(size_t i = 0u; i < cCount; ++i) {
+    pointers[i] = fibonacci->allocate(1000u);
+  }
+  void* slot = fibonacci->allocate(24u);
+  fibonacci->deallocate(pointers[3]);
+  fibonacci->deallocate(pointers[6]);
+  size_t rejected = 0u;
+  BusyLock::sBusy = true;
+  fibonacci->deallocate(pointers[0]);
+  fibonacci->deallocate(slot);
+  for(void* pointer : {pointers[3], pointers[0], slot}) { // on a free list, and pushed already twice
+    try {
+      fibonacci->deallocate(pointer);
+    }
+    catch(std::bad_alloc&) {
+      ++rejected;
+    }
+  }
+  BusyLock::sBusy = false;
+  try {
+    fibonacci->deallocate(pointers[0]); // still waiting in the list
+  }
+  catch(std::bad_alloc&) {
+    ++rejected;
+  }
+  fibonacci->coalesce();
+  void* again = fibonacci->allocate(1000u); // would walk the overwritten links of pointers[3]
+  fibonacci->deallocate(again);
+  for(size_t i = 0u; i < cCount; ++i) {
+    if(i != 0u && i != 3u && i != 6u) {
+      fibonacci->deallocate(pointers[i]);
+    }
+    else { // nothing to do
+    }
+  }
+  fibonacci->coalesce();
+  std::cout << " rejected " << rejected << " of 4 double frees\n";
+
+  if(rejected != 4u || !fibonacci->isCorrectEmpty()) {
+    std::cout << "########## !!!!!!!!!!!!!!!!! corrupt after freeing everything !!!!!!!!!!!!!!!!!!\n";
+  }
+  else {  // nothing to do
+  }
+  std::cout << cSeparator;
+  delete[] mem;
+}
+
+/// Counts its copies, and throws from the constructor if asked to.
+class Counted final {
+  std::vector<int> mPayload;
+
+public:
+  static size_t sCopies;
+  static size_t sLiving;
+
+  Counted(std::vector<int> aPayload, bool const aThrow) : mPayload(std::move(aPayload)) {
+    if(aThrow) {
+      throw std::runtime_error("Counted");
+    }
+    else { // nothing to do
+    }
+    ++sLiving;
+  }
+
+  Counted(Counted const &aOther) : mPayload(aOther.mPayload) {
+    ++sCopies;
+    ++sLiving;
+  }
+
+  ~Counted() {
+    --sLiving;
+  }
+
+  size_t size() const noexcept {
+    return mPayload.size();
+  }
+};
+
+size_t Counted::sCopies = 0u;
+size_t Counted::sLiving = 0u;
+
+void testSmartPointers(bool const aExact) {
+  uint8_t* mem = new uint8_t[cMemorySize];
+  StatisticsNewDelete::init(reinterpret_cast<void*>(mem), aExact);
+  std::cout << "Testing smart pointers with exact = " << aExact << '\n';
+  bool correct = true;
+  {
+    std::vector<int> payload(1000u, 7);
+    auto unique = StatisticsNewDelete::_makeUnique<Counted>(std::move(payload), false);
+    correct = correct && unique->size() == 1000u && sizeof(unique) == sizeof(Counted*);
+    auto shared = StatisticsNewDelete::_allocateShared<Counted>(std::vector<int>(500u, 3), false);
+    std::shared_ptr<Counted> other = shared;
+    correct = correct && shared->size() == 500u && other.use_count() == 2;
+    try {
+      StatisticsNewDelete::_makeUnique<Counted>(std::vector<int>(10u), true);
+      correct = false;
+    }
+    catch(std::runtime_error&) { // the block is freed by the placement delete
+    }
+    try {
+      StatisticsNewDelete::_allocateShared<Counted>(std::vector<int>(10u), true);
+      correct = false;
+    }
+    catch(std::runtime_error&) {
+    }
+  }
+  auto statistics = StatisticsNewDelete::getStatistics();
+  size_t allocations = 0u;
+  size_t deallocations = 0u;
+  for(size_t i = 0u; i < statistics.mIndexCount; ++i) {
+    allocations += statistics.mAllocations[i];
+    deallocations += statistics.mDeallocations[i];
+  }
+  std::cout << " copies: " << Counted::sCopies << " allocations: " << allocations << '\n';
+  correct = correct && Counted::sCopies == 0u && Counted::sLiving == 0u && allocations == 4u && deallocations == 4u; // one per object, even shared
+
+  if(!correct || !StatisticsNewDelete::isCorrectEmpty()) {
+    std::cout << "########## !!!!!!!!!!!!!!!!! corrupt after freeing everything !!!!!!!!!!!!!!!!!!\n";
+  }
+  else {  // nothing to do
+  }
+  std::cout << cSeparator;
+  delete[] mem;
+}
+
+template<typename tNewDelete, typename tConfig>
+void testHandles(char const * const aName, bool const aExact) {
+  uint8_t* mem = new uint8_t[cMemorySize];
+  tNewDelete::init(reinterpret_cast<void*>(mem), aExact);
+  std::cout << "Testing handles and compaction of " << aName << " with exact = " << aExact << '\n';
+
+  std::default_random_engine generator(1u);
+  std::uniform_int_distribution<size_t> distribution(cBenchmarkAllocSize / 2u, cBenchmarkAllocSize * 2u);
+  std::vector<typename tNewDelete::Handle> handles;
+  std::vector<size_t> sizes;
+  try {
+    while(true) {
+      size_t size = distribution(generator);
+      typename tNewDelete::Handle handle = tNewDelete::_allocateHandle(size);
+      uint8_t* pointer = static_cast<uint8_t*>(tNewDelete::pin(handle));
+      std::fill(pointer, pointer + size, static_cast<uint8_t>(handles.size()));
+      tNewDelete::unpin(handle);
+      handles.push_back(handle);
+      sizes.push_back(size);
+    }
+  }
+  catch(std::bad_alloc&) { // the heap or the handle table is full
+  }
+  typename tNewDelete::Handle freed = handles[0u];
+  for(size_t i = 0u; i < handles.size(); i += 2u) {
+    tNewDelete::_deallocateHandle(handles[i]);
+    handles[i] = 0u;
+  }
+  size_t maxFreeBefore = tNewDelete::getMaxFreeUserBlockSize();
+  size_t last = (handles.size() - 2u) | 1u; // the odd ones are alive
+  void* pinned = tNewDelete::pin(handles[last]);
+
+  size_t moved = 0u;
+  size_t calls = 0u;
+  size_t idle = 0u;
+  while(idle < tConfig::cHandleCount) { // until a whole sweep of the table moves nothing
+    size_t step = tNewDelete::compact(256u);
+    moved += step;
+    idle = (step > 0u ? 0u : idle + 256u);
+    ++calls;
+  }
+  size_t maxFreeAfter = tNewDelete::getMaxFreeUserBlockSize();
+  std::cout << " " << handles.size() / 2u << " live blocks, free space: " << tNewDelete::getFreeSpace() << ", largest free block before: " << maxFreeBefore <<
+               " after moving " << moved << " blocks in " << calls << " calls: " << maxFreeAfter << '\n';
+  bool correct = maxFreeAfter * 3u >= tNewDelete::getFreeSpace() && moved <= handles.size() / 2u && tNewDelete::pin(handles[last]) == pinned; // at least a third of the free space in one block, each live block moved at most once
+  size_t rejected = 0u;
+  for(auto invalid : {typename tNewDelete::Handle(0u), freed, handles[last], tConfig::cHandleCount + 1u}) {
+    try {
+      tNewDelete::_deallocateHandle(invalid);
+    }
+    catch(std::bad_alloc&) {
+      ++rejected;
+    }
+  }
+  tNewDelete::unpin(handles[last]);
+  tNewDelete::unpin(handles[last]);
+  tNewDelete::unpin(handles[last]); // not pinned any more, ignored
+  correct = correct && rejected == 4u && tNewDelete::pin(freed) == nullptr;
+
+  for(size_t i = 0u; i < handles.size(); ++i) {
+    if(handles[i] != 0u) {
+      uint8_t* pointer = static_cast<uint8_t*>(tNewDelete::pin(handles[i]));
+      correct = correct && std::count(pointer, pointer + sizes[i], static_cast<uint8_t>(i)) == static_cast<ptrdiff_t>(sizes[i]);
+      tNewDelete::unpin(handles[i]);
+      tNewDelete::_deallocateHandle(handles[i]);
+    }
+    else { // nothing to do
+    }
+  }
+  if(!correct || !tNewDelete::isCorrectEmpty()) {
+    std::cout << "########## !!!!!!!!!!!!!!!!! corrupt after freeing everything !!!!!!!!!!!!!!!!!!\n";
+  }
+  else {  // nothing to do
+  }
+  std::cout << cSeparator;
+  delete[] mem;
+}
+
+void testGrowth(bool const aExact) {
+  uint8_t* mem = new uint8_t[cMemorySize / 32u];
+  GrowingNewDelete::init(reinterpret_cast<void*>(mem), aExact);
+  std::cout << "Testing growth with exact = " << aExact << '\n';
+
+  size_t freeBefore = GrowingNewDelete::getFreeSpace();
+  void* resized = GrowingNewDelete::_allocate(GrowingNewDelete::getMaxFreeUserBlockSize() / 2u);
+  void* shrunk = GrowingNewDelete::_reallocate(resized, 16u); // gives back the rest of the block
+  size_t freeShrunk = GrowingNewDelete::getFreeSpace();
+  void* grown = GrowingNewDelete::_reallocate(shrunk, 1000u);  // merges the free right buddies
+  bool inPlace = shrunk == resized && grown == resized && freeShrunk > freeBefore - 1000u && GrowthInterface::sGrown == 0u;
+  GrowingNewDelete::_deallocate(grown);
+  std::cout << " reallocation " << (inPlace ? "stayed" : "did not stay") << " in place\n";
+
+  std::default_random_engine generator(4u);
+  std::uniform_int_distribution<size_t> distribution(1u, cBenchmarkAllocSize * 4u);
+  std::vector<uint8_t*> live;
+  try {
+    while(true) {
+      size_t size = distribution(generator);
+      uint8_t* pointer = (live.size() % 10u == 0u ? GrowingNewDelete::_newArrayAligned<uint8_t, 256u>(size) : GrowingNewDelete::_newArray<uint8_t>(size));
+      std::fill(pointer, pointer + size, static_cast<uint8_t>(live.size()));
+      live.push_back(pointer);
+    }
+  }
+  catch(std::bad_alloc&) { // all regions are full
+  }
+  bool correct = inPlace && GrowthInterface::sGrown == 3u && GrowingNewDelete::getRegionCount() == 3u;
+  std::cout << " allocated " << live.size() << " blocks using " << GrowingNewDelete::getRegionCount() << " additional regions\n";
+  for(size_t i = 0u; i < live.size(); ++i) {
+    correct = correct && live[i][0u] == static_cast<uint8_t>(i);
+    GrowingNewDelete::_deleteArray(live[i]);
+  }
+  correct = correct && GrowingNewDelete::isCorrectEmpty() && GrowingNewDelete::releaseEmptyRegions() == 3u && GrowthInterface::sReleased == 3u;
+  std::cout << " released " << GrowthInterface::sReleased << " regions\n";
+  GrowthInterface::sGrown = 0u;
+  GrowthInterface::sReleased = 0u;
+
+  if(!correct || !GrowingNewDelete::isCorrectEmpty()) {
+    std::cout << "########## !!!!!!!!!!!!!!!!! corrupt after freeing everything !!!!!!!!!!!!!!!!!!\n";
+  }
+  else {  // nothing to do
+  }
+  std::cout << cSeparator;
+  delete[] mem;
+}
+
+struct BulkPayload final {
+  uint8_t mData[200u];
+};
+
+void testBulkGrowth(bool const aExact) {
+  uint8_t* mem = new uint8_t[cMemorySize / 32u];
+  GrowingNewDelete::init(reinterpret_cast<void*>(mem), aExact);
+  std::cout << "Testing bulk growth with exact = " << aExact << '\n';
+
+  std::vector<BulkPayload*> objects(cMemorySize / 32u / sizeof(BulkPayload)); // more than the heap given to init holds with the headers
+  size_t count = GrowingNewDelete::_newBulk(objects.size(), objects.data());
+  size_t regionCount = GrowingNewDelete::getRegionCount();
+  bool correct = count == objects.size() && regionCount > 0u;
+  std::cout << " created " << count << " objects using " << regionCount << " additional regions\n";
+  for(size_t i = 0u; i < count; ++i) {
+    std::fill(objects[i]->mData, objects[i]->mData + sizeof(BulkPayload), static_cast<uint8_t>(i));
+  }
+  for(size_t i = 0u; i < count; ++i) {
+    correct = correct && objects[i]->mData[sizeof(BulkPayload) - 1u] == static_cast<uint8_t>(i);
+  }
+  BulkPayload* kept = objects[count - 1u]; // in an additional region
+  objects[count - 1u] = nullptr;           // skipped by _deleteBulk
+  GrowingNewDelete::_deleteBulk(objects.data(), count);
+  correct = correct && !GrowingNewDelete::isCorrectEmpty();
+  GrowingNewDelete::_deleteBulk(&kept, 1u);
+  correct = correct && GrowingNewDelete::isCorrectEmpty() && GrowingNewDelete::releaseEmptyRegions() == regionCount;
+  std::cout << " released " << GrowthInterface::sReleased << " regions\n";
+  GrowthInterface::sGrown = 0u;
+  GrowthInterface::sReleased = 0u;
+
+  if(!correct) {
+    std::cout << "########## !!!!!!!!!!!!!!!!! corrupt after freeing everything !!!!!!!!!!!!!!!!!!\n";
+  }
+  else {  // nothing to do
+  }
+  std::cout << cSeparator;
+  delete[] mem;
+}
+
+template<typename tNewDelete>
+void testRegions(char const * const aName, bool const aSmallestFit) {
+  uint8_t* fast = new uint8_t[FastRegion::cMemorySize];
+  uint8_t* large = new uint8_t[LargeRegion::cMemorySize];
+  uint8_t* middle = new uint8_t[MiddleRegion::cMemorySize];
+  void* memories[] = { fast, large, middle };
+  tNewDelete::init(memories, false);
+  std::cout << "Testing regions using " << aName << '\n';
+
+  size_t middleSize = tNewDelete::getFreeSpace(0u) * 2u; // fits only the large and the middle region
+  uint8_t* first = tNewDelete::template _newArray<uint8_t>(cThreadSmallSize);
+  uint8_t* hinted = tNewDelete::template _newArrayIn<uint8_t>(2u, cThreadSmallSize);
+  uint8_t* medium = tNewDelete::template _newArray<uint8_t>(middleSize);
+  bool correct = tNewDelete::getRegion(first) == 0u && tNewDelete::getRegion(hinted) == 2u &&
+                 tNewDelete::getRegion(medium) == (aSmallestFit ? 2u : 1u) && tNewDelete::getRegion(&correct) == tNewDelete::getRegionCount();
+
+  std::default_random_engine generator(3u);
+  std::uniform_int_distribution<size_t> distribution(1u, cBenchmarkAllocSize * 4u);
+  std::vector<uint8_t*> live;
+  std::array<size_t, 3u> counts {};
+  try {
+    while(true) {
+      size_t size = distribution(generator);
+      uint8_t* pointer = tNewDelete::template _newArray<uint8_t>(size);
+      std::fill(pointer, pointer + size, static_cast<uint8_t>(live.size()));
+      live.push_back(pointer);
+      ++counts[tNewDelete::getRegion(pointer)];
+    }
+  }
+  catch(std::bad_alloc&) { // all regions are full
+  }
+  std::cout << " allocated " << counts[0u] << ", " << counts[1u] << " and " << counts[2u] << " blocks in the fast, large and middle regions\n";
+  correct = correct && counts[0u] > 0u && counts[1u] > 0u && counts[2u] > 0u;
+  for(size_t i = 0u; i < live.size(); ++i) {
+    correct = correct && live[i][0u] == static_cast<uint8_t>(i);
+    tNewDelete::_deleteArray(live[i]);
+  }
+  tNewDelete::_deleteArray(first);
+  tNewDelete::_deleteArray(hinted);
+  tNewDelete::_deleteArray(medium);
+
+  if(!correct || !tNewDelete::isCorrectEmpty()) {
+    std::cout << "########## !!!!!!!!!!!!!!!!! corrupt after freeing everything !!!!!!!!!!!!!!!!!!\n";
+  }
+  else {  // nothing to do
+  }
+  std::cout << cSeparator;
+  delete[] fast;
+  delete[] large;
+  delete[] middle;
+}
+
+struct Vector final {
+  double mValues[8u];
+
+  Vector(double const aValue) {
+    std::fill(mValues, mValues + 8u, aValue);
+  }
+};
+
+template<typename tNewDelete>
+void testAligned(char const * const aName) {
+  uint8_t* mem = new uint8_t[cMemorySize];
+  tNewDelete::init(reinterpret_cast<void*>(mem), false);
+  std::cout << "Testing aligned allocation using " << aName << '\n';
+
+  constexpr size_t cCount = 100u;
+  std::array<uint8_t*, cCount> lines;
+  std::array<uint8_t*, cCount> pages;
+  std::array<Vector*, cCount> vectors;
+  bool correct = true;
+  size_t freeBefore = tNewDelete::getFreeSpace();
+  for(size_t i = 0u; i < cCount; ++i) {
+    lines[i] = tNewDelete::template _newArrayAligned<uint8_t, 64u>(1u + i * 7u);
+    pages[i] = tNewDelete::template _newArrayAligned<uint8_t, 4096u>(1u + i * 50u);
+    vectors[i] = tNewDelete::template _newAligned<Vector, 128u>(static_cast<double>(i));
+    correct = correct && reinterpret_cast<uintptr_t>(lines[i]) % 64u == 0u && reinterpret_cast<uintptr_t>(pages[i]) % 4096u == 0u && reinterpret_cast<uintptr_t>(vectors[i]) % 128u == 0u;
+    std::fill(lines[i], lines[i] + 1u + i * 7u, static_cast<uint8_t>(i));
+    std::fill(pages[i], pages[i] + 1u + i * 50u, static_cast<uint8_t>(i));
+  }
+  std::cout << " used " << (freeBefore - tNewDelete::getFreeSpace()) << " bytes for " << cCount << " line, page and vector allocations\n";
+  for(size_t i = 0u; i < cCount; ++i) {
+    correct = correct && lines[i][i * 7u] == static_cast<uint8_t>(i) && pages[i][i * 50u] == static_cast<uint8_t>(i) && vectors[i]->mValues[7u] == static_cast<double>(i);
+    tNewDelete::_deleteArray(lines[i]);
+    tNewDelete::_deleteArray(pages[i]);
+    tNewDelete::_delete(vectors[i]);
+  }
+
+  if(!correct || !tNewDelete::isCorrectEmpty()) {
+    std::cout << "########## !!!!!!!!!!!!!!!!! corrupt after freeing everything !!!!!!!!!!!!!!!!!!\n";
+  }
+  else {  // nothing to do
+  }
+  std::cout << cSeparator;
+  tNewDelete::teardown();
+  delete[] mem;
+}
+
+void testThreadCacheTeardown() {
+  uint8_t* mem = new uint8_t[cMemorySize];
+  CachedNewDelete::init(reinterpret_cast<void*>(mem), false);
+  std::cout << "Testing thread cache double free and teardown\n";
+
+  Vector* vector = CachedNewDelete::_new<Vector>(1.0);
+  CachedNewDelete::_delete(vector);
+  bool rejected = false;
+  try {
+    CachedNewDelete::_delete(vector); // still in the cache
+  }
+  catch(std::bad_alloc&) {
+    rejected = true;
+  }
+  vector = CachedNewDelete::_new<Vector>(2.0);
+  CachedNewDelete::_delete(vector); // in the cache of this thread
+  bool rejectedElsewhere = false;
+  std::thread other([vector, &rejectedElsewhere]() {
+    try {
+      CachedNewDelete::_delete(vector);
+    }
+    catch(std::bad_alloc&) {
+      rejectedElsewhere = true;
+    }
+  });
+  other.join();
+  rejected = rejected && rejectedElsewhere;
+  bool correct = rejected && CachedNewDelete::isCorrectEmpty();
+
+  std::atomic<bool> filled(false);
+  std::atomic<bool> exit(false);
+  std::thread thread([&filled, &exit]() {
+    for(size_t i = 0u; i < 10u; ++i) {
+      CachedNewDelete::_delete(CachedNewDelete::_new<Vector>(static_cast<double>(i)));
+    }
+    filled.store(true, std::memory_order_release);
+    while(!exit.load(std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+  });
+  while(!filled.load(std::memory_order_acquire)) {
+    std::this_thread::yield();
+  }
+  CachedNewDelete::teardown();
+  std::fill(mem, mem + cMemorySize, static_cast<uint8_t>(0xa5u)); // as if the memory was given to someone else
+  exit.store(true, std::memory_order_release);
+  thread.join();
+  correct = correct && std::all_of(mem, mem + cMemorySize, [](uint8_t const aByte) { return aByte == 0xa5u; });
+  std::cout << " double frees in the same and an other thread " << (rejected ? "rejected" : "accepted") << ", heap " << (correct ? "untouched" : "written") << " by the exiting thread\n";
+
+  if(!correct) {
+    std::cout << "########## !!!!!!!!!!!!!!!!! corrupt after freeing everything !!!!!!!!!!!!!!!!!!\n";
+  }
+  else {  // nothing to do
+  }
+  std::cout << cSeparator;
+  delete[] mem;
+}
+
 int main() {
   size_t technicalBlockSize;
   size_t maxUserBlockSize;
@@ -340,9 +1918,74 @@ int main() {
 
   testNewDelete(false);
   testNewDelete(true);
-  benchmarkNewDelete(false);
-  benchmarkNewDelete(true);
+  benchmarkNewDelete<ExampleNewDelete>("NewDelete", false);
+  benchmarkNewDelete<ExampleNewDelete>("NewDelete", true);
+  benchmarkNewDelete<IntrusiveNewDelete>("intrusive NewDelete", false);
+  benchmarkNewDelete<IntrusiveNewDelete>("intrusive NewDelete", true);
+  benchmarkBulk<IntrusiveNewDelete>("intrusive NewDelete", false);
+  benchmarkBulk<IntrusiveNewDelete>("intrusive NewDelete", true);
+  benchmarkBulk<ExampleNewDelete>("NewDelete", false);
+  benchmarkThreads<LockingNewDelete>("locking NewDelete");
+  benchmarkThreads<CachedNewDelete>("NewDelete with thread caches");
+  benchmarkThreads<ExampleShardedNewDelete>("ShardedNewDelete");
+  benchmarkThreads<PerIndexNewDelete>("NewDelete with per-index locking");
+  benchmarkThreads<LockingNewDelete>("locking NewDelete", true);
+  benchmarkThreads<PerIndexNewDelete>("NewDelete with per-index locking", true);
+  benchmarkProducerConsumer<InstanceNewDelete>("NewDelete with instance locking");
+  benchmarkProducerConsumer<RemoteFreeNewDelete>("NewDelete with remote free");
   testTooLargeRequest();
+  testDoubleFree<Fibonacci>("std::set", false);
+  testDoubleFree<IntrusiveFibonacci>("intrusive lists", true);
+  testReallocate(false);
+  testReallocate(true);
+  testAligned<ExampleNewDelete>("NewDelete");
+  testAligned<CachedNewDelete>("NewDelete with thread caches");
+  testThreadCacheTeardown();
+  benchmarkChurn<IntrusiveNewDelete>("intrusive NewDelete");
+  benchmarkChurn<LazyNewDelete>("NewDelete with lazy coalescing");
+  benchmarkReuse<ExampleNewDelete>("NewDelete reusing the lowest address", false);
+  benchmarkReuse<LastFreedNewDelete>("NewDelete reusing the last freed", true);
+  benchmarkReuse<SamePageNewDelete>("NewDelete reusing the same page", true);
+  benchmarkNewDelete<LastFreedNewDelete>("NewDelete reusing the last freed", true);
+  testAligned<LastFreedNewDelete>("NewDelete reusing the last freed");
+  testAligned<SamePageNewDelete>("NewDelete reusing the same page");
+  benchmarkNewDelete<LazyNewDelete>("NewDelete with lazy coalescing", false);
+  benchmarkBulk<LazyNewDelete>("NewDelete with lazy coalescing", false);
+  testAligned<LazyNewDelete>("NewDelete with lazy coalescing");
+  benchmarkNewDelete<PowerOfTwoNewDelete>("NewDelete with power of two block size", false);
+  benchmarkNewDelete<PowerOfTwoNewDelete>("NewDelete with power of two block size", true);
+  testAligned<PowerOfTwoNewDelete>("NewDelete with power of two block size");
+  testTables();
+  testFreeIndexSearch(false);
+  testFreeIndexSearch(true);
+  testDecommit(false);
+  testDecommit(true);
+  testStatistics<StatisticsNewDelete>(false);
+  testStatistics<StatisticsNewDelete>(true);
+  testStatistics<ShardedStatisticsNewDelete>(false);
+  testHeapWalk(false);
+  testHeapWalk(true);
+  testSlabs(false);
+  testSlabs(true);
+  testPersistence(false);
+  testPersistence(true);
+  testHeaderless(false);
+  testHeaderless(true);
+  testRemoteFreeDoubleFree(false);
+  testRemoteFreeDoubleFree(true);
+  benchmarkNewDelete<HeaderlessNewDelete>("headerless NewDelete", false);
+  testAligned<HeaderlessNewDelete>("headerless NewDelete");
+  testSmartPointers(false);
+  testSmartPointers(true);
+  testHandles<HandleNewDelete, HandleConfig>("NewDelete", false);
+  testHandles<HandleNewDelete, HandleConfig>("NewDelete", true);
+  testHandles<IntrusiveHandleNewDelete, IntrusiveHandleConfig>("intrusive NewDelete", false);
+  testGrowth(false);
+  testGrowth(true);
+  testBulkGrowth(false);
+  testBulkGrowth(true);
+  testRegions<FirstFitRegionNewDelete>("first fit RegionNewDelete", false);
+  testRegions<SmallestFitRegionNewDelete>("smallest fit RegionNewDelete", true);
 
   /*for(size_t i = 0u; i <= maxFibonacci; ++i) {
     size_t size = i * technicalBlockSize - cUserAlign;
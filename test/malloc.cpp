@@ -0,0 +1,116 @@
+// Build: g++ -std=c++14 -O2 -pthread -I. test/malloc.cpp tools/fibonaccimalloc.cpp -o malloc
+#include "FibonacciMalloc.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+constexpr size_t cAllocCount   = 100000u;
+constexpr size_t cMaxAllocSize =   3000u;
+constexpr size_t cHugeSize     = 64u * 1024u * 1024u;
+constexpr size_t cHugeCount    = 6u;    // more than the main heap
+constexpr size_t cThreadCount  = 4u;
+constexpr char   cSeparator[]  = "\n----------------------------------------------------\n\n";
+
+bool testBasics() {
+  std::cout << "Testing the C API\n";
+  void* empty = fmm_malloc(0u);
+  bool correct = empty != nullptr && fmm_usable_size(nullptr) == 0u;
+  fmm_free(empty);
+  fmm_free(nullptr);
+
+  uint8_t* zeros = static_cast<uint8_t*>(fmm_calloc(1000u, 3u));
+  correct = correct && zeros != nullptr && std::count(zeros, zeros + 3000u, 0u) == 3000 && fmm_usable_size(zeros) >= 3000u;
+  std::fill(zeros, zeros + 3000u, 0x5au);
+  fmm_free(zeros);
+  zeros = static_cast<uint8_t*>(fmm_calloc(3u, 1000u)); // probably the same block, cleared again
+  correct = correct && zeros != nullptr && std::count(zeros, zeros + 3000u, 0u) == 3000;
+  fmm_free(zeros);
+  errno = 0;
+  correct = correct && fmm_calloc(SIZE_MAX / 2u, 3u) == nullptr && errno == ENOMEM;
+
+  uint8_t* grown = static_cast<uint8_t*>(fmm_malloc(10u));
+  std::fill(grown, grown + 10u, 7u);
+  grown = static_cast<uint8_t*>(fmm_realloc(grown, 100000u));
+  correct = correct && std::count(grown, grown + 10u, 7u) == 10 && fmm_usable_size(grown) >= 100000u;
+  correct = correct && fmm_realloc(grown, 0u) == nullptr;
+
+  void* page = fmm_memalign(4096u, 100u);
+  void* line = nullptr;
+  correct = correct && reinterpret_cast<uintptr_t>(page) % 4096u == 0u && fmm_usable_size(page) >= 100u;
+  correct = correct && fmm_posix_memalign(&line, 64u, 10u) == 0 && reinterpret_cast<uintptr_t>(line) % 64u == 0u;
+  correct = correct && fmm_posix_memalign(&line, 48u, 10u) == EINVAL && fmm_memalign(3u, 10u) == nullptr;
+  fmm_free(page);
+  fmm_free(line);
+
+  std::vector<uint8_t*> huge;
+  for(size_t i = 0u; i < cHugeCount; ++i) { // served by additional regions
+    huge.push_back(static_cast<uint8_t*>(fmm_malloc(cHugeSize)));
+    correct = correct && huge.back() != nullptr;
+    huge.back()[0u] = huge.back()[cHugeSize - 1u] = static_cast<uint8_t>(i);
+  }
+  huge[0u] = static_cast<uint8_t*>(fmm_realloc(huge[0u], 2u * cHugeSize));
+  for(size_t i = 0u; i < cHugeCount; ++i) {
+    correct = correct && huge[i] != nullptr && huge[i][0u] == static_cast<uint8_t>(i) && (i == 0u || huge[i][cHugeSize - 1u] == static_cast<uint8_t>(i));
+    fmm_free(huge[i]);
+  }
+  std::cout << " " << cHugeCount << " blocks of " << cHugeSize << " bytes beyond the main heap\n";
+  return correct;
+}
+
+void churn(size_t const aSeed, bool& aCorrect) {
+  std::default_random_engine generator(aSeed);
+  std::uniform_int_distribution<size_t> distribution(1u, cMaxAllocSize);
+  std::vector<uint8_t*> live(cAllocCount / 10u, nullptr);
+  std::vector<size_t> sizes(live.size(), 0u);
+  bool correct = true;
+  for(size_t i = 0u; i < cAllocCount; ++i) {
+    size_t slot = distribution(generator) % live.size();
+    size_t size = (i % 2u == 0u ? distribution(generator) % 64u + 1u : distribution(generator));
+    correct = correct && (live[slot] == nullptr || std::count(live[slot], live[slot] + sizes[slot], static_cast<uint8_t>(slot)) == static_cast<ptrdiff_t>(sizes[slot]));
+    if(i % 3u == 0u) {
+      live[slot] = static_cast<uint8_t*>(fmm_realloc(live[slot], size));
+    }
+    else {
+      fmm_free(live[slot]);
+      live[slot] = static_cast<uint8_t*>(fmm_malloc(size));
+    }
+    std::fill(live[slot], live[slot] + size, static_cast<uint8_t>(slot));
+    sizes[slot] = size;
+  }
+  for(auto pointer : live) {
+    fmm_free(pointer);
+  }
+  aCorrect = correct;
+}
+
+int main() {
+  bool correct = testBasics();
+  std::cout << cSeparator;
+
+  std::cout << "Testing " << cThreadCount << " threads using malloc, realloc and free\n";
+  std::vector<std::thread> threads;
+  bool results[cThreadCount];
+  for(size_t i = 0u; i < cThreadCount; ++i) {
+    threads.emplace_back(churn, i, std::ref(results[i]));
+  }
+  for(auto& thread : threads) {
+    thread.join();
+  }
+  for(bool result : results) {
+    correct = correct && result;
+  }
+
+  if(!correct) {
+    std::cout << "########## !!!!!!!!!!!!!!!!! corrupt after freeing everything !!!!!!!!!!!!!!!!!!\n";
+  }
+  else {
+    std::cout << " all contents were intact\n";
+  }
+  std::cout << cSeparator;
+  return correct ? 0 : 1;
+}
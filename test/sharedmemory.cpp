@@ -0,0 +1,128 @@
+#include "FibonacciSharedMemory.h"
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <sys/wait.h>
+
+using namespace nowtech::memory;
+
+class Interface final {
+public:
+  static void badAlloc() {
+    throw std::bad_alloc();
+  }
+
+  static void lock() { // not used, the manager has its own locks
+  }
+
+  static void unlock() {
+  }
+};
+
+constexpr size_t cMemorySize           = 1024u * 1024u;
+constexpr size_t cMinBlockSize         =     128u;
+constexpr size_t cUserAlign            =       8u;
+constexpr size_t cFibonacciDifference  =       3u;
+constexpr size_t cProcessCount         =       4u;
+constexpr size_t cAllocCount           =     200u;
+constexpr size_t cMaxAllocSize         =     999u;
+constexpr char   cName[]               = "/nowtech-fibonacci-test";
+
+struct SharedConfig : public FibonacciConfig {
+  static constexpr bool cIntrusiveFreeLists = true;
+  static constexpr bool cPositionIndependent = true;
+  static constexpr size_t cSlabClassCount = 8u;
+  static constexpr FibonacciLocking cLocking = FibonacciLocking::cPerIndex;
+  typedef RobustMutex InstanceLock;
+};
+
+typedef FibonacciSharedMemory<Interface, cMemorySize, cMinBlockSize, cUserAlign, cFibonacciDifference, SharedConfig> SharedHeap;
+
+/// Lives in the shared heap, the children put the offsets of their blocks here.
+struct Mailbox final {
+  RobustMutex mMutex;
+  size_t      mOffsets[cProcessCount][cAllocCount];
+  size_t      mSizes[cProcessCount][cAllocCount];
+};
+
+int child(size_t const aIndex, size_t const aMailbox) {
+  int result = 0;
+  try {
+    SharedHeap heap(cName, false);
+    Mailbox* mailbox = static_cast<Mailbox*>(heap.toPointer(aMailbox));
+    std::default_random_engine generator(aIndex);
+    std::uniform_int_distribution<size_t> distribution(1u, cMaxAllocSize);
+    uint8_t* temporary[cAllocCount];
+    for(size_t i = 0u; i < cAllocCount; ++i) {
+      size_t size = distribution(generator) % (i % 2u == 0u ? 64u : cMaxAllocSize) + 1u;
+      uint8_t* pointer = static_cast<uint8_t*>(heap.getManager()->allocate(size));
+      std::fill(pointer, pointer + size, static_cast<uint8_t>(aIndex + i));
+      mailbox->mOffsets[aIndex][i] = heap.toOffset(pointer);
+      mailbox->mSizes[aIndex][i] = size;
+      temporary[i] = static_cast<uint8_t*>(heap.getManager()->allocate(size));
+    }
+    for(size_t i = 0u; i < cAllocCount; ++i) {
+      heap.getManager()->deallocate(temporary[i]);
+    }
+    if(aIndex == 0u) {
+      mailbox->mMutex.lock();
+      _exit(0); // dies holding it, with the mapping alive, so the system can mark it as left by a dead owner
+    }
+    else { // nothing to do
+    }
+  }
+  catch(std::bad_alloc&) {
+    result = 1;
+  }
+  return result;
+}
+
+int main() {
+  SharedHeap::remove(cName);
+  bool correct = true;
+  {
+    SharedHeap heap(cName, false);
+    std::cout << "Testing shared memory with " << cProcessCount << " processes, creator: " << heap.isCreator() << '\n';
+    Mailbox* mailbox = new(heap.getManager()->allocate(sizeof(Mailbox))) Mailbox();
+    size_t freeSpace = heap.getManager()->getFreeSpace();
+    size_t mailboxOffset = heap.toOffset(mailbox);
+    std::cout << std::flush;
+    pid_t children[cProcessCount];
+    for(size_t i = 0u; i < cProcessCount; ++i) {
+      children[i] = fork();
+      if(children[i] == 0) {
+        _exit(child(i, mailboxOffset));
+      }
+      else { // nothing to do
+      }
+    }
+    for(size_t i = 0u; i < cProcessCount; ++i) {
+      int status = 1;
+      waitpid(children[i], &status, 0);
+      correct = correct && children[i] > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    for(size_t i = 0u; i < cProcessCount; ++i) {
+      for(size_t j = 0u; j < cAllocCount; ++j) {
+        uint8_t* pointer = static_cast<uint8_t*>(heap.toPointer(mailbox->mOffsets[i][j]));
+        correct = correct && std::count(pointer, pointer + mailbox->mSizes[i][j], static_cast<uint8_t>(i + j)) == static_cast<ptrdiff_t>(mailbox->mSizes[i][j]);
+        heap.getManager()->deallocate(pointer);
+      }
+    }
+    mailbox->mMutex.lock();
+    std::cout << " recovered the mutex of a dead process " << mailbox->mMutex.getRecoveryCount() << " times\n";
+    correct = correct && mailbox->mMutex.getRecoveryCount() == 1u;
+    mailbox->mMutex.unlock();
+    heap.getManager()->coalesce();
+    correct = correct && heap.getManager()->getFreeSpace() == freeSpace;
+    heap.getManager()->deallocate(mailbox);
+    correct = correct && heap.getManager()->isCorrectEmpty();
+  }
+  SharedHeap::remove(cName);
+  if(!correct) {
+    std::cout << "########## !!!!!!!!!!!!!!!!! corrupt after freeing everything !!!!!!!!!!!!!!!!!!\n";
+  }
+  else {
+    std::cout << " all blocks of the other processes were intact\n";
+  }
+  return correct ? 0 : 1;
+}
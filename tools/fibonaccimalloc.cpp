@@ -0,0 +1,177 @@
+// Implements the C API of FibonacciMalloc.h over one global NewDelete.
+// The main heap and the additional regions are mapped using mmap, so nothing here calls malloc.
+// The sizes can be overridden when compiling, for example -DFMM_MEMORY_SIZE=1073741824.
+// Build: g++ -std=c++14 -O2 -fPIC -c -I. tools/fibonaccimalloc.cpp
+
+#include "FibonacciMalloc.h"
+#include "FibonacciMemoryManager.h"
+#include <cerrno>
+#include <sys/mman.h>
+
+#ifndef FMM_MEMORY_SIZE
+#define FMM_MEMORY_SIZE (256u * 1024u * 1024u)
+#endif
+
+#ifndef FMM_GROWTH_REGION_COUNT
+#define FMM_GROWTH_REGION_COUNT 15u
+#endif
+
+using namespace nowtech::memory;
+
+namespace {
+
+constexpr size_t cMemorySize          = FMM_MEMORY_SIZE;
+constexpr size_t cMinBlockSize        = 64u;
+constexpr size_t cAlignment           = alignof(std::max_align_t);
+constexpr size_t cFibonacciDifference = 1u;
+
+/// badAlloc returns, so the functions return nullptr like malloc.
+class MallocInterface final {
+public:
+  static void badAlloc() noexcept {
+    errno = ENOMEM;
+  }
+
+  static void lock() noexcept { // not used, the manager has its own lock
+  }
+
+  static void unlock() noexcept {
+  }
+
+  static void* grow(size_t const aSize) noexcept {
+    void* memory = mmap(nullptr, aSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return memory != MAP_FAILED ? memory : nullptr;
+  }
+
+  static void release(void* const aMemory, size_t const aSize) noexcept {
+    munmap(aMemory, aSize);
+  }
+};
+
+/// No thread caches, because their thread_local destructors would be registered using malloc.
+struct MallocConfig : public FibonacciConfig {
+  static constexpr bool cIntrusiveFreeLists = true;
+  static constexpr size_t cSlabClassCount = 16u; // up to 256 bytes
+  static constexpr size_t cSlabSize = 8192u;
+  static constexpr size_t cGrowthRegionCount = FMM_GROWTH_REGION_COUNT;
+  static constexpr bool cRemoteFree = true;
+  static constexpr FibonacciLocking cLocking = FibonacciLocking::cInstance;
+};
+
+typedef NewDelete<MallocInterface, cMemorySize, cMinBlockSize, cAlignment, cFibonacciDifference, 0u, MallocConfig> Heap;
+
+constexpr uint32_t cUninitialized = 0u;
+constexpr uint32_t cInitializing  = 1u;
+constexpr uint32_t cReady         = 2u;
+constexpr uint32_t cFailed        = 3u;
+
+std::atomic<uint32_t> gState { cUninitialized }; // constant initialized, so usable before the constructors run
+
+/// Creates the heap on the first call, the concurrent callers wait for it.
+bool ensureHeap() noexcept {
+  uint32_t state = gState.load(std::memory_order_acquire);
+  if(state == cUninitialized && gState.compare_exchange_strong(state, cInitializing, std::memory_order_acquire)) {
+    void* memory = MallocInterface::grow(cMemorySize);
+    if(memory != nullptr) {
+      Heap::init(memory, false);
+      state = cReady;
+    }
+    else {
+      state = cFailed;
+    }
+    gState.store(state, std::memory_order_release);
+  }
+  else { // nothing to do
+  }
+  while(state == cUninitialized || state == cInitializing) {
+    std::this_thread::yield();
+    state = gState.load(std::memory_order_acquire);
+  }
+  if(state == cFailed) {
+    errno = ENOMEM;
+  }
+  else { // nothing to do
+  }
+  return state == cReady;
+}
+
+bool isPowerOfTwo(size_t const aValue) noexcept {
+  return aValue > 0u && (aValue & (aValue - 1u)) == 0u;
+}
+
+}
+
+extern "C" {
+
+void* fmm_malloc(size_t aSize) {
+  return ensureHeap() ? Heap::_allocate(aSize > 0u ? aSize : 1u) : nullptr; // unique pointers for 0 like glibc
+}
+
+void fmm_free(void* aPointer) {
+  int error = errno; // free must not change it, even for an invalid pointer
+  if(aPointer != nullptr && ensureHeap()) {
+    Heap::_deallocate(aPointer);
+  }
+  else { // nothing to do
+  }
+  errno = error;
+}
+
+void* fmm_calloc(size_t aCount, size_t aSize) {
+  void* result = nullptr;
+  size_t size = aCount * aSize;
+  if(aSize > 0u && size / aSize != aCount) {
+    errno = ENOMEM;
+  }
+  else {
+    result = fmm_malloc(size);
+  }
+  if(result != nullptr) {
+    std::memset(result, 0, size);
+  }
+  else { // nothing to do
+  }
+  return result;
+}
+
+void* fmm_realloc(void* aPointer, size_t aSize) {
+  return ensureHeap() ? Heap::_reallocate(aPointer, aSize) : nullptr;
+}
+
+void* fmm_memalign(size_t aAlignment, size_t aSize) {
+  void* result = nullptr;
+  if(!isPowerOfTwo(aAlignment)) {
+    errno = EINVAL;
+  }
+  else if(ensureHeap()) {
+    result = Heap::_allocateAligned(aSize > 0u ? aSize : 1u, aAlignment);
+  }
+  else { // nothing to do
+  }
+  return result;
+}
+
+int fmm_posix_memalign(void** aResult, size_t aAlignment, size_t aSize) {
+  int result = 0;
+  int error = errno; // reported by the return value instead
+  if(!isPowerOfTwo(aAlignment) || aAlignment % sizeof(void*) != 0u) {
+    result = EINVAL;
+  }
+  else {
+    void* pointer = fmm_memalign(aAlignment, aSize);
+    if(pointer != nullptr) {
+      *aResult = pointer;
+    }
+    else {
+      result = ENOMEM;
+    }
+  }
+  errno = error;
+  return result;
+}
+
+size_t fmm_usable_size(void const* aPointer) {
+  return aPointer != nullptr && gState.load(std::memory_order_acquire) == cReady ? Heap::getUsableSize(aPointer) : 0u;
+}
+
+}
@@ -0,0 +1,62 @@
+// Replaces the C library allocator of a dynamically linked program by the one of FibonacciMalloc.h.
+// Build: g++ -std=c++14 -O2 -fPIC -shared -pthread -I. tools/fibonaccimalloc.cpp tools/fibonaccipreload.cpp -o libfibonaccimalloc.so
+// Usage: LD_PRELOAD=./libfibonaccimalloc.so <program>
+// The operator new of libstdc++ calls malloc, so C++ programs are covered too.
+// Memory allocated before loading, for example by the dynamic linker, is never passed to these.
+
+#include "FibonacciMalloc.h"
+#include <cerrno>
+#include <unistd.h>
+
+namespace {
+
+size_t getPageSize() noexcept {
+  return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+}
+
+extern "C" {
+
+void* malloc(size_t aSize) {
+  return fmm_malloc(aSize);
+}
+
+void free(void* aPointer) {
+  fmm_free(aPointer);
+}
+
+void* calloc(size_t aCount, size_t aSize) {
+  return fmm_calloc(aCount, aSize);
+}
+
+void* realloc(void* aPointer, size_t aSize) {
+  return fmm_realloc(aPointer, aSize);
+}
+
+void* memalign(size_t aAlignment, size_t aSize) {
+  return fmm_memalign(aAlignment, aSize);
+}
+
+int posix_memalign(void** aResult, size_t aAlignment, size_t aSize) {
+  return fmm_posix_memalign(aResult, aAlignment, aSize);
+}
+
+void* aligned_alloc(size_t aAlignment, size_t aSize) {
+  return fmm_memalign(aAlignment, aSize);
+}
+
+void* valloc(size_t aSize) {
+  return fmm_memalign(getPageSize(), aSize);
+}
+
+void* pvalloc(size_t aSize) {
+  size_t pageSize = getPageSize();
+  return fmm_memalign(pageSize, (aSize + pageSize - 1u) / pageSize * pageSize);
+}
+
+size_t malloc_usable_size(void* aPointer) {
+  return fmm_usable_size(aPointer);
+}
+
+}
@@ -0,0 +1,182 @@
+// Reads a snapshot written by FibonacciMemoryManager::dump() and prints
+// a summary, a histogram by Fibonacci index and an occupancy map.
+// Usage: heapanalyzer <snapshot file> [map columns] [map rows]
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+constexpr uint32_t cDumpMagic      = 0x48424946u; // "FIBH"
+constexpr uint32_t cDumpVersion    = 2u;
+constexpr size_t   cDumpHeaderSize = 40u;
+constexpr uint32_t cDumpFreeBit    = 1u << 31u;
+constexpr size_t   cDefaultColumns = 64u;
+constexpr size_t   cDefaultRows    = 16u;
+
+class Reader final {
+private:
+  std::vector<uint8_t> const& mData;
+  size_t                      mPosition = 0u;
+
+public:
+  Reader(std::vector<uint8_t> const& aData) noexcept : mData(aData) {
+  }
+
+  bool has(size_t const aByteCount) const noexcept {
+    return mPosition + aByteCount <= mData.size();
+  }
+
+  uint64_t read(size_t const aByteCount) noexcept {
+    uint64_t result = 0u;
+    for(size_t i = 0u; i < aByteCount; ++i) {
+      result |= static_cast<uint64_t>(mData[mPosition + i]) << (i * 8u);
+    }
+    mPosition += aByteCount;
+    return result;
+  }
+};
+
+struct Block final {
+  uint64_t mOffset;
+  uint64_t mSize;
+  size_t   mIndex;
+  bool     mFree;
+};
+
+struct IndexStatistics final {
+  size_t   mUsedCount = 0u;
+  size_t   mFreeCount = 0u;
+  uint64_t mUsedBytes = 0u;
+  uint64_t mFreeBytes = 0u;
+};
+
+void printMap(std::vector<Block> const& aBlocks, uint64_t const aHeapSize, size_t const aColumns, size_t const aRows) {
+  size_t cellCount = aColumns * aRows;
+  std::vector<uint64_t> usedBytes(cellCount, 0u);
+  double cellSize = static_cast<double>(aHeapSize) / static_cast<double>(cellCount);
+  for(auto const& block : aBlocks) {
+    if(!block.mFree) {
+      uint64_t from = block.mOffset;
+      uint64_t to = block.mOffset + block.mSize;
+      while(from < to) {
+        size_t cell = std::min(static_cast<size_t>(static_cast<double>(from) / cellSize), cellCount - 1u);
+        uint64_t cellEnd = std::min(static_cast<uint64_t>(static_cast<double>(cell + 1u) * cellSize), aHeapSize);
+        uint64_t end = (cellEnd > from && cellEnd < to ? cellEnd : to);
+        usedBytes[cell] += end - from;
+        from = end;
+      }
+    }
+    else { // nothing to do
+    }
+  }
+  std::cout << "\nOccupancy map, one character is " << static_cast<uint64_t>(cellSize) << " bytes ('#' used, '+' partly used, '.' free):\n";
+  for(size_t row = 0u; row < aRows; ++row) {
+    std::cout << ' ';
+    for(size_t column = 0u; column < aColumns; ++column) {
+      uint64_t used = usedBytes[row * aColumns + column];
+      std::cout << (used == 0u ? '.' : (static_cast<double>(used) >= cellSize - 1.0 ? '#' : '+'));
+    }
+    std::cout << '\n';
+  }
+}
+
+int main(int aArgc, char** aArgv) {
+  if(aArgc < 2) {
+    std::cerr << "Usage: " << aArgv[0] << " <snapshot file> [map columns] [map rows]\n";
+    return 1;
+  }
+  else { // nothing to do
+  }
+  std::ifstream file(aArgv[1], std::ios::binary);
+  std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  size_t columns = (aArgc > 2 ? std::strtoul(aArgv[2], nullptr, 10) : cDefaultColumns);
+  size_t rows = (aArgc > 3 ? std::strtoul(aArgv[3], nullptr, 10) : cDefaultRows);
+  Reader reader(data);
+  if(!reader.has(cDumpHeaderSize) || reader.read(sizeof(uint32_t)) != cDumpMagic || reader.read(sizeof(uint32_t)) != cDumpVersion || columns == 0u || rows == 0u) {
+    std::cerr << "Not a version " << cDumpVersion << " FibonacciMemoryManager snapshot: " << aArgv[1] << '\n';
+    return 1;
+  }
+  else { // nothing to do
+  }
+  uint64_t difference = reader.read(sizeof(uint32_t));
+  size_t fibonacciCount = reader.read(sizeof(uint32_t));
+  uint64_t blockSize = reader.read(sizeof(uint64_t));
+  uint64_t headerSize = reader.read(sizeof(uint64_t)); // 0 for headerless blocks
+  size_t blockCount = reader.read(sizeof(uint64_t));
+  if(!reader.has(fibonacciCount * sizeof(uint64_t) + blockCount * sizeof(uint32_t))) {
+    std::cerr << "Truncated snapshot: " << aArgv[1] << '\n';
+    return 1;
+  }
+  else { // nothing to do
+  }
+  std::vector<uint64_t> fibonaccis(fibonacciCount);
+  for(auto& fibonacci : fibonaccis) {
+    fibonacci = reader.read(sizeof(uint64_t));
+  }
+
+  std::vector<Block> blocks;
+  std::vector<IndexStatistics> indices(fibonacciCount);
+  uint64_t offset = 0u;
+  uint64_t usedBytes = 0u;
+  uint64_t freeBytes = 0u;
+  uint64_t largestFree = 0u;
+  for(size_t i = 0u; i < blockCount; ++i) {
+    uint32_t value = static_cast<uint32_t>(reader.read(sizeof(uint32_t)));
+    Block block { offset, 0u, value & ~cDumpFreeBit, (value & cDumpFreeBit) != 0u };
+    if(block.mIndex >= fibonacciCount) {
+      std::cerr << "Invalid index " << block.mIndex << " at block " << i << '\n';
+      return 1;
+    }
+    else { // nothing to do
+    }
+    block.mSize = blockSize * fibonaccis[block.mIndex];
+    uint64_t userBytes = block.mSize - headerSize;
+    IndexStatistics& statistics = indices[block.mIndex];
+    if(block.mFree) {
+      ++statistics.mFreeCount;
+      statistics.mFreeBytes += userBytes;
+      freeBytes += userBytes;
+      largestFree = std::max(largestFree, userBytes);
+    }
+    else {
+      ++statistics.mUsedCount;
+      statistics.mUsedBytes += userBytes;
+      usedBytes += userBytes;
+    }
+    blocks.push_back(block);
+    offset += block.mSize;
+  }
+  uint64_t heapSize = blockSize * fibonaccis.back();
+
+  std::cout << "D: " << difference << "  N: " << fibonacciCount << "  block size: " << blockSize << "  header size: " << headerSize << "  heap: " << heapSize << " bytes\n";
+  std::cout << "blocks: " << blockCount << "  used: " << usedBytes << " bytes  free: " << freeBytes << " bytes  largest free: " << largestFree << " bytes";
+  if(freeBytes > 0u) {
+    std::cout << "  external fragmentation: " << std::setprecision(3) << 1.0 - static_cast<double>(largestFree) / static_cast<double>(freeBytes);
+  }
+  else { // nothing to do
+  }
+  std::cout << '\n';
+  if(offset != heapSize) {
+    std::cout << "Warning: the blocks cover " << offset << " bytes instead of " << heapSize << '\n';
+  }
+  else { // nothing to do
+  }
+
+  std::cout << "\nindex   user size      used      free    used bytes    free bytes\n";
+  for(size_t i = 0u; i < fibonacciCount; ++i) {
+    IndexStatistics const& statistics = indices[i];
+    if(statistics.mUsedCount + statistics.mFreeCount > 0u) {
+      std::cout << std::setw(5) << i << std::setw(12) << blockSize * fibonaccis[i] - headerSize << std::setw(10) << statistics.mUsedCount << std::setw(10) << statistics.mFreeCount
+                << std::setw(14) << statistics.mUsedBytes << std::setw(14) << statistics.mFreeBytes << '\n';
+    }
+    else { // nothing to do
+    }
+  }
+  printMap(blocks, heapSize, columns, rows);
+  return 0;
+}